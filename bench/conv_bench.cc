@@ -0,0 +1,653 @@
+/**
+ * @file
+ *
+ * Microbenchmarks for conv.
+ *
+ *      conv_bench [filter] [min-seconds]
+ *
+ * Each benchmark runs a pass over a fixed data set until min-seconds
+ * (0.2 by default) have elapsed, and reports ns/op, MB/s of text read
+ * or written, and heap allocations per operation.
+ * Container and parse() benchmarks count one element as one operation.
+ * Only benchmarks whose names contain filter are run.
+ * Built with CONV_ENABLE_STATS, it also reports iostream fallbacks.
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Kenichiro IDA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <conv/conv.h>
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+size_t allocations = 0;
+
+void* counted_malloc(size_t size) {
+    ++allocations;
+
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return counted_malloc(size); }
+void* operator new[](size_t size) { return counted_malloc(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+const size_t kSamples = 1024;
+
+const char* filter = "";
+double min_seconds = 0.2;
+volatile size_t checksum = 0;
+
+template <typename F>
+void bench(const char* name, size_t bytes, F pass) {
+    if (!std::strstr(name, filter)) {
+        return;
+    }
+
+    checksum = checksum + pass();
+    conv::reset_stats();
+
+    size_t passes = 0;
+    size_t allocs = allocations;
+    bench_clock::time_point start = bench_clock::now();
+    double elapsed = 0;
+
+    do {
+        checksum = checksum + pass();
+        ++passes;
+        elapsed =
+            std::chrono::duration<double>(bench_clock::now() - start).count();
+    } while (elapsed < min_seconds);
+
+    allocs = allocations - allocs;
+
+    double ops = static_cast<double>(passes * kSamples);
+
+    std::printf("%-40s %10.1f ns/op %10.1f MB/s %8.2f allocs/op", name,
+                elapsed * 1e9 / ops, bytes * passes / elapsed / 1e6,
+                allocs / ops);
+
+#if defined(CONV_ENABLE_STATS)
+    std::printf(" %8.2f fallbacks/op",
+                conv::stats().total().stream_fallbacks / ops);
+#endif
+
+    std::printf("\n");
+}
+
+template <typename C>
+size_t text_size(const C& c) {
+    size_t size = 0;
+
+    for (size_t i = 0; i < c.size(); ++i) {
+        size += c[i].size();
+    }
+
+    return size;
+}
+
+//-----------------------------------------------------------------------------
+
+struct data_set {
+    std::vector<int> short_ints;
+    std::vector<long long> long_ints;
+    std::vector<double> doubles;
+
+    std::vector<std::string> short_int_texts;
+    std::vector<std::string> long_int_texts;
+    std::vector<std::string> hex_texts;
+    std::vector<std::string> double_texts;
+    std::vector<std::string> bool_texts;
+    std::vector<std::string> ascii_texts;
+    std::vector<std::string> utf8_texts;
+    std::vector<std::wstring> wide_texts;
+
+    std::string int_list;
+    std::string double_list;
+    std::string map_text;
+    std::string matrix_text;
+    std::string csv_text;
+
+    std::map<std::string, int> map;
+
+    data_set() {
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<int> small(-999, 999);
+        std::uniform_int_distribution<long long> large(
+            std::numeric_limits<long long>::min(),
+            std::numeric_limits<long long>::max());
+        std::uniform_real_distribution<double> mantissa(1.0, 10.0);
+        std::uniform_int_distribution<int> exponent(-30, 30);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(4, 24);
+
+        static const char* const utf8_words[] = {
+            "\xe6\x9d\xb1\xe4\xba\xac",  // Tokyo
+            "caf\xc3\xa9",               // cafe
+            "\xce\xb1\xce\xb2\xce\xb3",  // alpha beta gamma
+            "na\xc3\xafve",              // naive
+        };
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            short_ints.push_back(small(rng));
+            long_ints.push_back(large(rng));
+            doubles.push_back(mantissa(rng) *
+                              std::pow(10.0, exponent(rng)));
+
+            short_int_texts.push_back(conv::to<std::string>(short_ints[i]));
+            long_int_texts.push_back(conv::to<std::string>(long_ints[i]));
+            double_texts.push_back(conv::to<std::string>(doubles[i]));
+
+            char hex[32];
+            std::snprintf(hex, sizeof(hex), "0x%llx",
+                          static_cast<unsigned long long>(long_ints[i]) >> 4);
+            hex_texts.push_back(hex);
+
+            std::string ascii;
+            std::string utf8;
+
+            for (int n = length(rng); n > 0; --n) {
+                ascii.push_back(static_cast<char>(letter(rng)));
+            }
+
+            for (int n = length(rng) / 4; n >= 0; --n) {
+                utf8 += utf8_words[rng() % 4];
+            }
+
+            bool_texts.push_back(short_ints[i] < 0 ? "true" : "false");
+            ascii_texts.push_back(ascii);
+            utf8_texts.push_back(utf8);
+            wide_texts.push_back(conv::to<std::wstring>(utf8));
+
+            map[ascii] = short_ints[i];
+        }
+
+        int_list = conv::to<std::string>(short_ints);
+        double_list = conv::to<std::string>(doubles);
+        map_text = conv::to<std::string>(map);
+
+        std::vector<std::vector<int> > matrix;
+
+        for (size_t i = 0; i < kSamples; i += 8) {
+            matrix.push_back(std::vector<int>(short_ints.begin() + i,
+                                              short_ints.begin() + i + 8));
+        }
+
+        matrix_text = conv::to<std::string>(matrix);
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            csv_text += short_int_texts[i] + "," + double_texts[i] + "," +
+                        ascii_texts[i] + "\n";
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+void bench_parse_numbers(const data_set& d) {
+    bench("to<int>(short string)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<int>(d.short_int_texts[i]);
+        }
+
+        return sum;
+    });
+
+    bench("strtol(short string)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::strtol(d.short_int_texts[i].c_str(), NULL, 10);
+        }
+
+        return sum;
+    });
+
+    bench("to<long long>(long string)", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<long long>(d.long_int_texts[i]);
+        }
+
+        return sum;
+    });
+
+    bench("strtoll(long string)", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::strtoll(d.long_int_texts[i].c_str(), NULL, 10);
+        }
+
+        return sum;
+    });
+
+    bench("to<long long>(hex string)", text_size(d.hex_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<long long>(d.hex_texts[i]);
+        }
+
+        return sum;
+    });
+
+    bench("strtoll(hex string)", text_size(d.hex_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::strtoll(d.hex_texts[i].c_str(), NULL, 16);
+        }
+
+        return sum;
+    });
+
+    bench("to<double>(string)", text_size(d.double_texts), [&] {
+        double sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<double>(d.double_texts[i]);
+        }
+
+        return static_cast<size_t>(sum != 0);
+    });
+
+    bench("strtod(string)", text_size(d.double_texts), [&] {
+        double sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::strtod(d.double_texts[i].c_str(), NULL);
+        }
+
+        return static_cast<size_t>(sum != 0);
+    });
+
+    bench("to<char>(string)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += static_cast<unsigned char>(
+                conv::to<char>(d.short_int_texts[i]));
+        }
+
+        return sum;
+    });
+
+    bench("to<bool>(string)", text_size(d.bool_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<bool>(d.bool_texts[i]);
+        }
+
+        return sum;
+    });
+
+#if defined(CONV_HAS_CXX17)
+    bench("from_chars<int>", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            const std::string& s = d.short_int_texts[i];
+            int value = 0;
+            std::from_chars(s.data(), s.data() + s.size(), value);
+            sum += value;
+        }
+
+        return sum;
+    });
+
+    bench("from_chars<long long>", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            const std::string& s = d.long_int_texts[i];
+            long long value = 0;
+            std::from_chars(s.data(), s.data() + s.size(), value);
+            sum += value;
+        }
+
+        return sum;
+    });
+#endif
+
+#if defined(CONV_HAS_FLOAT_CHARCONV)
+    bench("from_chars<double>", text_size(d.double_texts), [&] {
+        double sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            const std::string& s = d.double_texts[i];
+            double value = 0;
+            std::from_chars(s.data(), s.data() + s.size(), value);
+            sum += value;
+        }
+
+        return static_cast<size_t>(sum != 0);
+    });
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void bench_format_numbers(const data_set& d) {
+    bench("to<string>(short int)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::string>(d.short_ints[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("snprintf(short int)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+        char buf[32];
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::snprintf(buf, sizeof(buf), "%d", d.short_ints[i]);
+        }
+
+        return sum;
+    });
+
+    bench("to<string>(long long)", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::string>(d.long_ints[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("snprintf(long long)", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+        char buf[32];
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::snprintf(buf, sizeof(buf), "%lld", d.long_ints[i]);
+        }
+
+        return sum;
+    });
+
+    bench("to<string>(double)", text_size(d.double_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::string>(d.doubles[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("snprintf(double)", text_size(d.double_texts), [&] {
+        size_t sum = 0;
+        char buf[64];
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::snprintf(buf, sizeof(buf), "%g", d.doubles[i]);
+        }
+
+        return sum;
+    });
+
+    bench("to<string>(bool)", kSamples * 5, [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::string>(d.short_ints[i] < 0).size();
+        }
+
+        return sum;
+    });
+
+    bench("formatted_size(long long)", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::formatted_size(d.long_ints[i]);
+        }
+
+        return sum;
+    });
+
+#if defined(CONV_HAS_CXX17)
+    bench("to_chars(long long)", text_size(d.long_int_texts), [&] {
+        size_t sum = 0;
+        char buf[32];
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::to_chars(buf, buf + sizeof(buf), d.long_ints[i]).ptr -
+                   buf;
+        }
+
+        return sum;
+    });
+#endif
+
+#if defined(CONV_HAS_FLOAT_CHARCONV)
+    bench("to_chars(double)", text_size(d.double_texts), [&] {
+        size_t sum = 0;
+        char buf[64];
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::to_chars(buf, buf + sizeof(buf), d.doubles[i],
+                                 std::chars_format::general, 6)
+                       .ptr -
+                   buf;
+        }
+
+        return sum;
+    });
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void bench_wide(const data_set& d) {
+    bench("to<wstring>(ascii string)", text_size(d.ascii_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::wstring>(d.ascii_texts[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("to<wstring>(utf-8 string)", text_size(d.utf8_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::wstring>(d.utf8_texts[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("mbstowcs(utf-8 string)", text_size(d.utf8_texts), [&] {
+        size_t sum = 0;
+        wchar_t buf[256];
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += std::mbstowcs(buf, d.utf8_texts[i].c_str(), 256);
+        }
+
+        return sum;
+    });
+
+    bench("to<string>(wstring)", text_size(d.utf8_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::string>(d.wide_texts[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("to<wstring>(int)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            sum += conv::to<std::wstring>(d.short_ints[i]).size();
+        }
+
+        return sum;
+    });
+
+    bench("to<int>(wstring)", text_size(d.short_int_texts), [&] {
+        size_t sum = 0;
+        std::wstring text;
+
+        for (size_t i = 0; i < kSamples; ++i) {
+            text.assign(d.short_int_texts[i].begin(),
+                        d.short_int_texts[i].end());
+            sum += conv::to<int>(text);
+        }
+
+        return sum;
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void bench_containers(const data_set& d) {
+    bench("to<string>(vector<int>)", d.int_list.size(), [&] {
+        return conv::to<std::string>(d.short_ints).size();
+    });
+
+    bench("to<string>(vector<double>)", d.double_list.size(), [&] {
+        return conv::to<std::string>(d.doubles).size();
+    });
+
+    bench("to<string>(map<string, int>)", d.map_text.size(), [&] {
+        return conv::to<std::string>(d.map).size();
+    });
+
+    bench("to<vector<int>>(vector<string>)", text_size(d.short_int_texts),
+          [&] {
+              return conv::to<std::vector<int> >(d.short_int_texts).size();
+          });
+
+    bench("to<string_column>(vector<int>)", text_size(d.short_int_texts), [&] {
+        return conv::to<conv::string_column>(d.short_ints).size();
+    });
+
+    bench("formatted_size(vector<int>)", text_size(d.short_int_texts), [&] {
+        return conv::formatted_size(d.short_ints);
+    });
+}
+
+//-----------------------------------------------------------------------------
+
+void bench_parse(const data_set& d) {
+    bench("parse<vector<int>>", d.int_list.size(), [&] {
+        return conv::parse<std::vector<int> >(d.int_list).size();
+    });
+
+    bench("parse<vector<double>>", d.double_list.size(), [&] {
+        return conv::parse<std::vector<double> >(d.double_list).size();
+    });
+
+    bench("parse<map<string, int>>", d.map_text.size(), [&] {
+        return conv::parse<std::map<std::string, int> >(d.map_text).size();
+    });
+
+    bench("parse<vector<vector<int>>>", d.matrix_text.size(), [&] {
+        return conv::parse<std::vector<std::vector<int> > >(d.matrix_text)
+            .size();
+    });
+
+    bench("parse<columns<int, double, string>>", d.csv_text.size(), [&] {
+        typedef conv::columns<int, double, std::string> table_t;
+        return conv::parse<table_t>(d.csv_text).rows();
+    });
+
+    bench("parse_into(int*)", d.int_list.size(), [&] {
+        static int out[kSamples];
+        return conv::parse_into(out, kSamples, d.int_list);
+    });
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        filter = argv[1];
+    }
+
+    if (argc > 2) {
+        min_seconds = std::atof(argv[2]);
+    }
+
+    if (!std::setlocale(LC_ALL, "C.UTF-8")) {
+        std::setlocale(LC_ALL, "en_US.UTF-8");
+    }
+
+    data_set d;
+
+    bench_parse_numbers(d);
+    bench_format_numbers(d);
+    bench_wide(d);
+    bench_containers(d);
+    bench_parse(d);
+
+    return 0;
+}
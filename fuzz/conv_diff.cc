@@ -0,0 +1,799 @@
+/**
+ * @file
+ *
+ * Randomized differential test of conv against reference conversions.
+ *
+ *      conv_diff [seconds] [seed]
+ *
+ * Generates batches of edge values, random digit strings, boundary
+ * floating point values and valid and invalid UTF-8, converts each batch
+ * with conv and with the C library (strtoll, strtoull, strtod, strtof,
+ * snprintf) or a reference UTF-8 codec, and compares the results until
+ * the time budget (10 seconds by default) runs out.
+ * Prints the throughput of both sides and the first mismatches of each
+ * engine, and exits with 1 if any mismatch was found.
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Kenichiro IDA
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <chrono>
+#include <climits>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <conv/conv.h>
+
+namespace {
+
+typedef std::chrono::steady_clock diff_clock;
+typedef std::mt19937_64 rng_t;
+
+const size_t kBatch = 4096;
+const size_t kReported = 5;
+
+double seconds_since(diff_clock::time_point start) {
+    return std::chrono::duration<double>(diff_clock::now() - start).count();
+}
+
+std::string escape(const std::string& s) {
+    std::string out;
+
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+
+        if (c >= 0x20 && c < 0x7f) {
+            out.push_back(static_cast<char>(c));
+        } else {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\x%02x", c);
+            out += buf;
+        }
+    }
+
+    return out;
+}
+
+//-----------------------------------------------------------------------------
+
+class engine {
+   public:
+    explicit engine(const char* name)
+          : name_(name),
+            cases_(0),
+            skipped_(0),
+            mismatches_(0),
+            conv_seconds_(0),
+            ref_seconds_(0) {}
+
+    virtual ~engine() {}
+
+    const char* name() const { return name_; }
+    unsigned long long mismatches() const { return mismatches_; }
+
+    void run(rng_t& rng) {
+        inputs_.clear();
+
+        for (size_t i = 0; i < kBatch; ++i) {
+            inputs_.push_back(generate(rng));
+        }
+
+        diff_clock::time_point start = diff_clock::now();
+        convert();
+        conv_seconds_ += seconds_since(start);
+
+        start = diff_clock::now();
+        reference();
+        ref_seconds_ += seconds_since(start);
+
+        for (size_t i = 0; i < kBatch; ++i) {
+            std::string got;
+            std::string expected;
+
+            switch (compare(i, got, expected)) {
+                case skip:
+                    ++skipped_;
+                    break;
+                case mismatch:
+                    if (mismatches_++ < kReported) {
+                        std::printf("  %s: \"%s\" -> %s, expected %s\n", name_,
+                                    escape(inputs_[i]).c_str(),
+                                    escape(got).c_str(),
+                                    escape(expected).c_str());
+                    }
+                    break;
+                case match:
+                    break;
+            }
+        }
+
+        cases_ += kBatch;
+    }
+
+    void report() const {
+        std::printf(
+            "%-22s %12llu cases %8llu skipped %6llu mismatches "
+            "%9.1f Mops/s conv %9.1f Mops/s reference\n",
+            name_, cases_, skipped_, mismatches_,
+            cases_ / conv_seconds_ / 1e6, cases_ / ref_seconds_ / 1e6);
+    }
+
+   protected:
+    enum outcome { match, mismatch, skip };
+
+    virtual std::string generate(rng_t& rng) = 0;
+    virtual void convert() = 0;
+    virtual void reference() = 0;
+    virtual outcome compare(size_t i, std::string& got,
+                            std::string& expected) = 0;
+
+    std::vector<std::string> inputs_;
+
+   private:
+    const char* name_;
+    unsigned long long cases_;
+    unsigned long long skipped_;
+    unsigned long long mismatches_;
+    double conv_seconds_;
+    double ref_seconds_;
+};
+
+//-----------------------------------------------------------------------------
+
+std::string random_digits(rng_t& rng, size_t n, const char* alphabet,
+                          size_t radix) {
+    std::string s;
+
+    for (size_t i = 0; i < n; ++i) {
+        s.push_back(alphabet[rng() % radix]);
+    }
+
+    return s;
+}
+
+std::string integer_text(rng_t& rng) {
+    static const char* const edges[] = {
+        "0",
+        "1",
+        "-1",
+        "127",
+        "-128",
+        "255",
+        "32767",
+        "-32768",
+        "65535",
+        "2147483647",
+        "-2147483648",
+        "2147483648",
+        "4294967295",
+        "4294967296",
+        "9223372036854775807",
+        "-9223372036854775808",
+        "9223372036854775808",
+        "-9223372036854775809",
+        "18446744073709551615",
+        "18446744073709551616",
+        "99999999999999999999",
+    };
+
+    std::string s;
+
+    switch (rng() % 4) {
+        case 0:
+            s = edges[rng() % (sizeof(edges) / sizeof(edges[0]))];
+            break;
+        case 1:
+            s = std::string(rng() % 4, '0') +
+                random_digits(rng, 1 + rng() % 9, "0123456789", 10);
+            break;
+        default:
+            s = random_digits(rng, 1 + rng() % 22, "0123456789", 10);
+            break;
+    }
+
+    if (s[0] != '-' && rng() % 3 == 0) {
+        s.insert(s.begin(), rng() % 2 ? '-' : '+');
+    }
+
+    if (rng() % 8 == 0) {
+        s = std::string(1 + rng() % 3, ' ') + s + std::string(rng() % 3, ' ');
+    }
+
+    return s;
+}
+
+template <typename T>
+class integer_engine : public engine {
+   public:
+    typedef T (*reference_t)(const std::string&);
+
+    integer_engine(const char* name, bool hex, reference_t ref)
+          : engine(name), hex_(hex), ref_(ref) {}
+
+   protected:
+    std::string generate(rng_t& rng) {
+        if (!hex_) {
+            return integer_text(rng);
+        }
+
+        return "0x" + random_digits(rng, 1 + rng() % 18,
+                                    "0123456789abcdefABCDEF", 22);
+    }
+
+    void convert() {
+        got_.resize(inputs_.size());
+
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            got_[i] = conv::to<T>(inputs_[i]);
+        }
+    }
+
+    void reference() {
+        expected_.resize(inputs_.size());
+
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            expected_[i] = ref_(inputs_[i]);
+        }
+    }
+
+    outcome compare(size_t i, std::string& got, std::string& expected) {
+        got = conv::to<std::string>(got_[i]);
+        expected = conv::to<std::string>(expected_[i]);
+        return got_[i] == expected_[i] ? match : mismatch;
+    }
+
+   private:
+    bool hex_;
+    reference_t ref_;
+    std::vector<T> got_;
+    std::vector<T> expected_;
+};
+
+int ref_int(const std::string& s) {
+    long long v = std::strtoll(s.c_str(), NULL, 10);
+    return v > INT_MAX ? INT_MAX : v < INT_MIN ? INT_MIN : static_cast<int>(v);
+}
+
+long long ref_long_long(const std::string& s) {
+    return std::strtoll(s.c_str(), NULL, 10);
+}
+
+unsigned long long ref_unsigned_long_long(const std::string& s) {
+    return std::strtoull(s.c_str(), NULL, 10);
+}
+
+long long ref_hex_long_long(const std::string& s) {
+    return std::strtoll(s.c_str(), NULL, 16);
+}
+
+unsigned long long ref_hex_unsigned_long_long(const std::string& s) {
+    return std::strtoull(s.c_str(), NULL, 16);
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+T random_finite(rng_t& rng) {
+    typedef typename std::conditional<sizeof(T) == 4, unsigned int,
+                                      unsigned long long>::type bits_t;
+
+    for (;;) {
+        bits_t bits = static_cast<bits_t>(rng());
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        if (value == value && value - value == 0) {
+            return value;
+        }
+    }
+}
+
+template <typename T>
+std::string floating_text(rng_t& rng) {
+    const T edges[] = {
+        T(0),
+        T(1),
+        std::numeric_limits<T>::min(),
+        std::numeric_limits<T>::max(),
+        std::numeric_limits<T>::denorm_min(),
+        std::numeric_limits<T>::epsilon(),
+        T(0.1),
+        T(1) / T(3),
+    };
+
+    char buf[64];
+
+    switch (rng() % 4) {
+        case 0: {
+            T value = edges[rng() % (sizeof(edges) / sizeof(edges[0]))];
+            std::snprintf(buf, sizeof(buf), "%.*g",
+                          static_cast<int>(1 + rng() % 17),
+                          static_cast<double>(rng() % 2 ? -value : value));
+            return buf;
+        }
+        case 1: {
+            std::string s = random_digits(rng, 1 + rng() % 20, "0123456789", 10);
+            s.insert(1 + rng() % s.size(), ".");
+            int exponent = static_cast<int>(rng() % 80) - 40;
+
+            if (rng() % 2) {
+                s += "e" + conv::to<std::string>(exponent);
+            }
+
+            return s;
+        }
+        default: {
+            double value = static_cast<double>(random_finite<T>(rng));
+            std::snprintf(buf, sizeof(buf), rng() % 2 ? "%.*g" : "%.*e",
+                          static_cast<int>(rng() % 18), value);
+            return buf;
+        }
+    }
+}
+
+template <typename T>
+class floating_parse_engine : public engine {
+   public:
+    explicit floating_parse_engine(const char* name) : engine(name) {}
+
+   protected:
+    std::string generate(rng_t& rng) { return floating_text<T>(rng); }
+
+    void convert() {
+        got_.resize(inputs_.size());
+
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            got_[i] = conv::to<T>(inputs_[i]);
+        }
+    }
+
+    void reference() {
+        expected_.resize(inputs_.size());
+
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            expected_[i] = strto(inputs_[i].c_str(), T());
+        }
+    }
+
+    outcome compare(size_t i, std::string& got, std::string& expected) {
+        bool same = std::memcmp(&got_[i], &expected_[i], sizeof(T)) == 0;
+
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.17g", static_cast<double>(got_[i]));
+        got = buf;
+        std::snprintf(buf, sizeof(buf), "%.17g",
+                      static_cast<double>(expected_[i]));
+        expected = buf;
+
+        return same ? match : mismatch;
+    }
+
+   private:
+    static double strto(const char* s, double) { return std::strtod(s, NULL); }
+    static float strto(const char* s, float) { return std::strtof(s, NULL); }
+
+    std::vector<T> got_;
+    std::vector<T> expected_;
+};
+
+//-----------------------------------------------------------------------------
+
+class integer_format_engine : public engine {
+   public:
+    integer_format_engine() : engine("format long long") {}
+
+   protected:
+    std::string generate(rng_t& rng) {
+        long long value = static_cast<long long>(rng());
+
+        switch (rng() % 3) {
+            case 0:
+                value >>= rng() % 64;
+                break;
+            case 1:
+                value = rng() % 2 ? std::numeric_limits<long long>::min()
+                                  : std::numeric_limits<long long>::max();
+                value -= static_cast<long long>(rng() % 3) * (value < 0 ? -1 : 1);
+                break;
+        }
+
+        values_.push_back(value);
+        return std::string();
+    }
+
+    void convert() {
+        got_.resize(values_.size());
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            got_[i] = conv::to<std::string>(values_[i]);
+        }
+    }
+
+    void reference() {
+        expected_.resize(values_.size());
+        char buf[32];
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            std::snprintf(buf, sizeof(buf), "%lld", values_[i]);
+            expected_[i] = buf;
+        }
+    }
+
+    outcome compare(size_t i, std::string& got, std::string& expected) {
+        got = got_[i];
+        expected = expected_[i];
+        outcome result = got == expected &&
+                                 conv::formatted_size(values_[i]) == got.size()
+                             ? match
+                             : mismatch;
+
+        if (i + 1 == values_.size()) {
+            values_.clear();
+        }
+
+        return result;
+    }
+
+   private:
+    std::vector<long long> values_;
+    std::vector<std::string> got_;
+    std::vector<std::string> expected_;
+};
+
+class floating_format_engine : public engine {
+   public:
+    floating_format_engine() : engine("format double") {}
+
+   protected:
+    std::string generate(rng_t& rng) {
+        values_.push_back(random_finite<double>(rng));
+        return std::string();
+    }
+
+    void convert() {
+        got_.resize(values_.size());
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            got_[i] = conv::to<std::string>(values_[i]);
+        }
+    }
+
+    void reference() {
+        expected_.resize(values_.size());
+        char buf[64];
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            std::snprintf(buf, sizeof(buf), "%g", values_[i]);
+            expected_[i] = buf;
+        }
+    }
+
+    outcome compare(size_t i, std::string& got, std::string& expected) {
+        got = got_[i];
+        expected = expected_[i];
+        outcome result = got == expected &&
+                                 conv::formatted_size(values_[i]) == got.size()
+                             ? match
+                             : mismatch;
+
+        if (i + 1 == values_.size()) {
+            values_.clear();
+        }
+
+        return result;
+    }
+
+   private:
+    std::vector<double> values_;
+    std::vector<std::string> got_;
+    std::vector<std::string> expected_;
+};
+
+//-----------------------------------------------------------------------------
+
+void encode_utf8(std::string& out, unsigned long c) {
+    if (c < 0x80) {
+        out.push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (c >> 6)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+    } else if (c < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (c >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (c >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+    }
+}
+
+// Decodes strict UTF-8 (RFC 3629) up to the first invalid sequence.
+// beyond is set when that sequence is a well-formed encoding of a value
+// above U+10FFFF, which some C libraries (glibc) still decode.
+std::wstring decode_utf8(const std::string& s, bool& beyond) {
+    std::wstring out;
+    size_t i = 0;
+    beyond = false;
+
+    while (i < s.size()) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        size_t n = c < 0x80 ? 0 : c >= 0xc2 && c < 0xe0 ? 1
+                              : c >= 0xe0 && c < 0xf0   ? 2
+                              : c >= 0xf0 && c < 0xf5   ? 3
+                                                        : 4;
+
+        if (n == 4 || i + n >= s.size()) {
+            break;
+        }
+
+        unsigned long code = n == 0 ? c : c & (0x3f >> n);
+        bool valid = true;
+
+        for (size_t k = 1; k <= n; ++k) {
+            unsigned char cc = static_cast<unsigned char>(s[i + k]);
+            valid = valid && (cc & 0xc0) == 0x80;
+            code = (code << 6) | (cc & 0x3f);
+        }
+
+        static const unsigned long minimum[] = {0, 0x80, 0x800, 0x10000};
+
+        if (!valid || code < minimum[n] || code > 0x10ffff ||
+            (code >= 0xd800 && code < 0xe000)) {
+            beyond = valid && code > 0x10ffff;
+            break;
+        }
+
+        out.push_back(static_cast<wchar_t>(code));
+        i += n + 1;
+    }
+
+    return out;
+}
+
+unsigned long random_code_point(rng_t& rng) {
+    static const unsigned long limits[] = {0x80, 0x800, 0x10000, 0x110000};
+
+    for (;;) {
+        unsigned long c = static_cast<unsigned long>(rng() % limits[rng() % 4]);
+
+        if (c != 0 && (c < 0xd800 || c >= 0xe000)) {
+            return c;
+        }
+    }
+}
+
+class utf8_decode_engine : public engine {
+   public:
+    utf8_decode_engine() : engine("utf-8 -> wstring") {}
+
+   protected:
+    std::string generate(rng_t& rng) {
+        std::string s;
+
+        for (size_t n = rng() % 12; n > 0; --n) {
+            encode_utf8(s, random_code_point(rng));
+        }
+
+        if (!s.empty() && rng() % 4 == 0) {
+            static const char* const broken[] = {
+                "\x80",          // stray continuation byte
+                "\xc0\xaf",      // overlong '/'
+                "\xe0\x80\xaf",  // overlong '/'
+                "\xed\xa0\x80",  // surrogate
+                "\xf4\x90\x80\x80",  // above U+10FFFF
+                "\xff",
+                "\xe3\x81",  // truncated
+            };
+
+            s.insert(rng() % s.size(),
+                     broken[rng() % (sizeof(broken) / sizeof(broken[0]))]);
+        }
+
+        return s;
+    }
+
+    void convert() {
+        got_.resize(inputs_.size());
+
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            got_[i] = conv::to<std::wstring>(inputs_[i]);
+        }
+    }
+
+    void reference() {
+        expected_.resize(inputs_.size());
+        beyond_.resize(inputs_.size());
+
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            bool beyond;
+            expected_[i] = decode_utf8(inputs_[i], beyond);
+            beyond_[i] = beyond;
+        }
+    }
+
+    outcome compare(size_t i, std::string& got, std::string& expected) {
+        if (beyond_[i]) {
+            return skip;
+        }
+
+        got = hex(got_[i]);
+        expected = hex(expected_[i]);
+        return got_[i] == expected_[i] ? match : mismatch;
+    }
+
+   private:
+    static std::string hex(const std::wstring& w) {
+        std::string out = "[";
+
+        for (size_t i = 0; i < w.size(); ++i) {
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), i ? " %lx" : "%lx",
+                          static_cast<unsigned long>(w[i]));
+            out += buf;
+        }
+
+        return out + "]";
+    }
+
+    std::vector<std::wstring> got_;
+    std::vector<std::wstring> expected_;
+    std::vector<bool> beyond_;
+};
+
+class utf8_encode_engine : public engine {
+   public:
+    utf8_encode_engine() : engine("wstring -> utf-8") {}
+
+   protected:
+    std::string generate(rng_t& rng) {
+        std::wstring w;
+        std::string s;
+
+        for (size_t n = rng() % 12; n > 0; --n) {
+            unsigned long c = random_code_point(rng);
+            w.push_back(static_cast<wchar_t>(c));
+            encode_utf8(s, c);
+        }
+
+        wide_.push_back(w);
+        return s;
+    }
+
+    void convert() {
+        got_.resize(wide_.size());
+
+        for (size_t i = 0; i < wide_.size(); ++i) {
+            got_[i] = conv::to<std::string>(wide_[i]);
+        }
+    }
+
+    void reference() {
+        expected_.resize(wide_.size());
+
+        for (size_t i = 0; i < wide_.size(); ++i) {
+            expected_[i].clear();
+
+            for (size_t k = 0; k < wide_[i].size(); ++k) {
+                encode_utf8(expected_[i],
+                            static_cast<unsigned long>(wide_[i][k]));
+            }
+        }
+    }
+
+    outcome compare(size_t i, std::string& got, std::string& expected) {
+        got = got_[i];
+        expected = expected_[i];
+        outcome result =
+            got == expected && got == inputs_[i] ? match : mismatch;
+
+        if (i + 1 == wide_.size()) {
+            wide_.clear();
+        }
+
+        return result;
+    }
+
+   private:
+    std::vector<std::wstring> wide_;
+    std::vector<std::string> got_;
+    std::vector<std::string> expected_;
+};
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    double budget = argc > 1 ? std::atof(argv[1]) : 10.0;
+    unsigned long long seed =
+        argc > 2 ? std::strtoull(argv[2], NULL, 10)
+                 : static_cast<unsigned long long>(
+                       diff_clock::now().time_since_epoch().count());
+
+    if (!std::setlocale(LC_ALL, "C.UTF-8") &&
+        !std::setlocale(LC_ALL, "en_US.UTF-8")) {
+        std::printf("warning: no UTF-8 locale, transcoding is not tested\n");
+    }
+
+    bool utf8 = MB_CUR_MAX > 1;
+
+    std::printf("seed %llu, budget %.1f s\n", seed, budget);
+
+    rng_t rng(seed);
+
+    integer_engine<int> parse_int("parse int", false, ref_int);
+    integer_engine<long long> parse_long_long("parse long long", false,
+                                              ref_long_long);
+    integer_engine<unsigned long long> parse_unsigned(
+        "parse unsigned", false, ref_unsigned_long_long);
+    integer_engine<long long> parse_hex("parse hex long long", true,
+                                        ref_hex_long_long);
+    integer_engine<unsigned long long> parse_hex_unsigned(
+        "parse hex unsigned", true, ref_hex_unsigned_long_long);
+    floating_parse_engine<double> parse_double("parse double");
+    floating_parse_engine<float> parse_float("parse float");
+    integer_format_engine format_integer;
+    floating_format_engine format_double;
+    utf8_decode_engine decode;
+    utf8_encode_engine encode;
+
+    std::vector<engine*> engines;
+    engines.push_back(&parse_int);
+    engines.push_back(&parse_long_long);
+    engines.push_back(&parse_unsigned);
+    engines.push_back(&parse_hex);
+    engines.push_back(&parse_hex_unsigned);
+    engines.push_back(&parse_double);
+    engines.push_back(&parse_float);
+    engines.push_back(&format_integer);
+    engines.push_back(&format_double);
+
+    if (utf8) {
+        engines.push_back(&decode);
+        engines.push_back(&encode);
+    }
+
+    diff_clock::time_point start = diff_clock::now();
+
+    do {
+        for (size_t i = 0; i < engines.size(); ++i) {
+            engines[i]->run(rng);
+        }
+    } while (seconds_since(start) < budget);
+
+    unsigned long long mismatches = 0;
+
+    for (size_t i = 0; i < engines.size(); ++i) {
+        engines[i]->report();
+        mismatches += engines[i]->mismatches();
+    }
+
+    return mismatches ? 1 : 0;
+}
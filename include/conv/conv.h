@@ -38,13 +38,19 @@
  *      m["c"] = 2;
  *      std::string mstring = conv::to<std::string>(m);  // "{a: 0, b: 1, c: 2}"
  *
- * but it now only supports std::pair, std::vector and std::map.
+ * std::deque, std::list, std::set, std::unordered_set, std::unordered_map
+ * and std::flat_map (where available) work the same way,
+ * plus std::tuple, std::array, std::optional and std::variant with C++17.
  *
  * When you want to convert user defined type of T to string,
  * you should define operator<<(std::ostream&, T).
  * And conv::to<std::string>(T) will be enabled.
  * (conv::to<std::string>() for STL containers are like so.)
  *
+ * Defining conv_format(conv::sink&, const T&) and
+ * bool conv_parse(const conv::source&, T&) in the namespace of T
+ * makes conv write and read T directly, without iostreams.
+ *
  * The MIT License (MIT)
  *
  * Copyright (c) 2015 Kenichiro IDA
@@ -71,445 +77,4992 @@
 #define CONV_CONV_H_
 
 #include <cassert>
+#include <clocale>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
-
+#include <cstring>
+#include <cwchar>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <locale>
 #include <map>
+#include <memory>
+#include <set>
 #include <sstream>
+#include <streambuf>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if defined(_MSVC_LANG)
+#define CONV_CPLUSPLUS _MSVC_LANG
+#else
+#define CONV_CPLUSPLUS __cplusplus
+#endif
+
+#if CONV_CPLUSPLUS >= 201703L
+#define CONV_HAS_CXX17 1
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <variant>
+#endif
+
+#if CONV_CPLUSPLUS >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#define CONV_HAS_SPAN 1
+#include <span>
+#endif
+#endif
+
+#if CONV_CPLUSPLUS > 202002L && defined(__has_include)
+#if __has_include(<flat_map>)
+#include <flat_map>
+#if defined(__cpp_lib_flat_map)
+#define CONV_HAS_FLAT_MAP 1
+#endif
+#endif
+#if __has_include(<flat_set>)
+#include <flat_set>
+#if defined(__cpp_lib_flat_set)
+#define CONV_HAS_FLAT_SET 1
+#endif
+#endif
+#endif
+
+#if defined(__cpp_lib_to_chars)
+#define CONV_HAS_FLOAT_CHARCONV 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONV_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__PCLMUL__) && defined(__x86_64__)
+#define CONV_HAS_PCLMUL 1
+#include <wmmintrin.h>
+#endif
+
+#if defined(__SIZEOF_INT128__)
+#define CONV_HAS_INT128 1
+#endif
+
+#if defined(CONV_ENABLE_STATS) || defined(CONV_ENABLE_LATENCY)
+#include <atomic>
+#include <mutex>
+#include <new>
+#endif
+
+#if defined(CONV_ENABLE_LATENCY)
+#include <chrono>
+#include <typeinfo>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+#endif
+
 namespace conv {
 
-inline const std::string& version() {
-    static std::string ver("0.3.4");
-    return ver;
-}
+// A string literal that compares, converts and streams like the
+// std::string version() used to return, without a static std::string.
+class version_string {
+   public:
+    template <size_t N>
+    constexpr version_string(const char (&str)[N])
+          : data_(str), size_(N - 1) {}
 
-//-----------------------------------------------------------------------------
+    constexpr const char* data() const { return data_; }
+    constexpr const char* c_str() const { return data_; }
+    constexpr size_t size() const { return size_; }
 
-namespace internal {
+    operator std::string() const { return std::string(data_, size_); }
 
-template <typename CharT>
-const std::basic_string<CharT>& space();
+#if defined(CONV_HAS_CXX17)
+    constexpr operator std::string_view() const {
+        return std::string_view(data_, size_);
+    }
+#endif
 
-template <>
-inline const std::string& space<char>() {
-    static const std::string s(" \t\v\r\n");
-    return s;
+   private:
+    const char* data_;
+    size_t size_;
+};
+
+inline bool operator==(const version_string& a, const char* b) {
+    return std::strcmp(a.c_str(), b) == 0;
 }
 
-template <>
-inline const std::wstring& space<wchar_t>() {
-    static const std::wstring s(L" \t\v\r\n");
-    return s;
+inline bool operator==(const char* a, const version_string& b) {
+    return b == a;
 }
 
-//-----------------------------------------------------------------------------
+inline bool operator==(const version_string& a, const std::string& b) {
+    return b.compare(0, std::string::npos, a.data(), a.size()) == 0;
+}
 
-template <typename CharT>
-const std::basic_string<CharT>& hex();
+inline bool operator==(const std::string& a, const version_string& b) {
+    return b == a;
+}
 
-template <>
-inline const std::string& hex<char>() {
-    static const std::string s("0x");
-    return s;
+inline bool operator!=(const version_string& a, const char* b) {
+    return !(a == b);
 }
 
-template <>
-inline const std::wstring& hex<wchar_t>() {
-    static const std::wstring s(L"0x");
-    return s;
+inline bool operator!=(const char* a, const version_string& b) {
+    return !(b == a);
 }
 
-}  // namespace internal
+inline bool operator!=(const version_string& a, const std::string& b) {
+    return !(a == b);
+}
 
-//-----------------------------------------------------------------------------
+inline bool operator!=(const std::string& a, const version_string& b) {
+    return !(b == a);
+}
 
-template <typename T>
-class to {
-   public:
-    template <typename U>
-    explicit to(const U& value) {
-        value_ = static_cast<T>(value);
-    }
+inline std::ostream& operator<<(std::ostream& out, const version_string& v) {
+    return out.write(v.data(), static_cast<std::streamsize>(v.size()));
+}
 
-    explicit to(const char* str) { from_string<char>(str); }
-    explicit to(const std::string& str) { from_string<char>(str); }
+constexpr version_string version() { return version_string("0.3.4"); }
 
-    explicit to(const wchar_t* str) { from_string<wchar_t>(str); }
-    explicit to(const std::wstring& str) { from_string<wchar_t>(str); }
+//-----------------------------------------------------------------------------
 
-    operator T() const { return value_; }
+#if defined(CONV_HAS_INT128)
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
 
-   private:
-    template <typename CharT>
-    void from_string(const std::basic_string<CharT>& str) {
-        typedef std::basic_string<CharT> string_t;
-        typedef std::basic_istringstream<CharT> isstream_t;
+template <typename T>
+struct fixed_point {
+    T value;
+    unsigned scale;
+};
+
+template <typename T>
+inline fixed_point<T> fixed(T value, unsigned scale) {
+    fixed_point<T> f = {value, scale};
+    return f;
+}
 
-        static const string_t& space = internal::space<CharT>();
-        static const string_t& hex = internal::hex<CharT>();
+//-----------------------------------------------------------------------------
 
-        size_t first = str.find_first_not_of(space);
-        assert(first != string_t::npos);
+enum stat_kind {
+    stat_format,
+    stat_read,
+    stat_parse,
+    stat_convert,
+    stat_transcode,
+    stat_kind_count
+};
 
-        size_t last = str.find_last_not_of(space);
-        assert(last != string_t::npos);
+struct stat_counters {
+    stat_counters()
+          : calls(0),
+            allocations(0),
+            allocated_bytes(0),
+            streams(0),
+            stream_fallbacks(0) {}
+
+    stat_counters& operator+=(const stat_counters& other) {
+        calls += other.calls;
+        allocations += other.allocations;
+        allocated_bytes += other.allocated_bytes;
+        streams += other.streams;
+        stream_fallbacks += other.stream_fallbacks;
+        return *this;
+    }
 
-        string_t trimmed = str.substr(first, last - first + 1);
-        assert(trimmed.find_first_of(space) == string_t::npos);
+    unsigned long long calls;
+    unsigned long long allocations;
+    unsigned long long allocated_bytes;
+    unsigned long long streams;
+    unsigned long long stream_fallbacks;
+};
 
-        isstream_t in(trimmed);
+struct conversion_stats {
+    const stat_counters& operator[](stat_kind kind) const {
+        return kinds[kind];
+    }
 
-        if (in.str().size() >= 2 && in.str().substr(0, 2) == hex) {
-            in >> std::hex >> value_;
-        } else {
-            in >> value_;
+    stat_counters total() const {
+        stat_counters sum;
+
+        for (int i = 0; i < stat_kind_count; ++i) {
+            sum += kinds[i];
         }
+
+        return sum;
     }
 
-    T value_;
+    stat_counters kinds[stat_kind_count];
 };
 
-//-----------------------------------------------------------------------------
+namespace internal {
 
-template <>
-class to<char> {
+#if defined(CONV_ENABLE_STATS)
+class stats_block {
    public:
-    template <typename U>
-    explicit to(const U& value) {
-        value_ = static_cast<char>(value);
+    enum field {
+        calls,
+        allocations,
+        allocated_bytes,
+        streams,
+        stream_fallbacks,
+        field_count
+    };
+
+    stats_block() { clear(); }
+
+    void add(int kind, field f, unsigned long long n) {
+        std::atomic<unsigned long long>& c = counts_[kind][f];
+        c.store(c.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
     }
 
-    explicit to(const char* str) { value_ = static_cast<char>(to<int>(str)); }
-
-    explicit to(const std::string& str) {
-        value_ = static_cast<char>(to<int>(str));
+    void add_to(conversion_stats& stats) const {
+        for (int i = 0; i < stat_kind_count; ++i) {
+            stat_counters& k = stats.kinds[i];
+            k.calls += get(i, calls);
+            k.allocations += get(i, allocations);
+            k.allocated_bytes += get(i, allocated_bytes);
+            k.streams += get(i, streams);
+            k.stream_fallbacks += get(i, stream_fallbacks);
+        }
     }
 
-    explicit to(const wchar_t* wstr) {
-        value_ = static_cast<char>(to<int>(wstr));
+    void clear() {
+        for (int i = 0; i < stat_kind_count; ++i) {
+            for (int j = 0; j < field_count; ++j) {
+                counts_[i][j].store(0, std::memory_order_relaxed);
+            }
+        }
     }
 
-    explicit to(const std::wstring& wstr) {
-        value_ = static_cast<char>(to<int>(wstr));
+   private:
+    unsigned long long get(int kind, field f) const {
+        return counts_[kind][f].load(std::memory_order_relaxed);
     }
 
-    operator char() const { return value_; }
-
-   private:
-    char value_;
+    std::atomic<unsigned long long> counts_[stat_kind_count][field_count];
 };
 
-//-----------------------------------------------------------------------------
-
-template <>
-class to<signed char> {
+class stats_registry {
    public:
-    template <typename U>
-    explicit to(const U& value) {
-        value_ = static_cast<signed char>(value);
+    static stats_registry& instance() {
+        static stats_registry registry;
+        return registry;
     }
 
-    explicit to(const char* str) {
-        value_ = static_cast<signed char>(to<int>(str));
+    void attach(stats_block* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocks_.push_back(block);
     }
 
-    explicit to(const std::string& str) {
-        value_ = static_cast<signed char>(to<int>(str));
+    void detach(stats_block* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        block->add_to(retired_);
+        blocks_.erase(std::find(blocks_.begin(), blocks_.end(), block));
     }
 
-    explicit to(const wchar_t* wstr) {
-        value_ = static_cast<signed char>(to<int>(wstr));
-    }
+    conversion_stats collect() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        conversion_stats stats = retired_;
 
-    explicit to(const std::wstring& wstr) {
-        value_ = static_cast<signed char>(to<int>(wstr));
+        for (size_t i = 0; i < blocks_.size(); ++i) {
+            blocks_[i]->add_to(stats);
+        }
+
+        return stats;
     }
 
-    operator signed char() const { return value_; }
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_ = conversion_stats();
+
+        for (size_t i = 0; i < blocks_.size(); ++i) {
+            blocks_[i]->clear();
+        }
+    }
 
    private:
-    signed char value_;
+    std::mutex mutex_;
+    std::vector<stats_block*> blocks_;
+    conversion_stats retired_;
 };
 
-//-----------------------------------------------------------------------------
-
-template <>
-class to<unsigned char> {
+class local_stats {
    public:
-    template <typename U>
-    explicit to(const U& value) {
-        value_ = static_cast<unsigned char>(value);
+    static stats_block& block() {
+        static thread_local local_stats stats;
+        return stats.block_;
     }
 
-    explicit to(const char* str) {
-        value_ = static_cast<unsigned char>(to<int>(str));
+    static int& depth() {
+        static thread_local int depth = 0;
+        return depth;
     }
 
-    explicit to(const std::string& str) {
-        value_ = static_cast<unsigned char>(to<int>(str));
+    static int& kind() {
+        static thread_local int kind = stat_format;
+        return kind;
     }
 
-    explicit to(const wchar_t* str) {
-        value_ = static_cast<unsigned char>(to<int>(str));
-    }
+   private:
+    local_stats() { stats_registry::instance().attach(&block_); }
+    ~local_stats() { stats_registry::instance().detach(&block_); }
 
-    explicit to(const std::wstring& wstr) {
-        value_ = static_cast<unsigned char>(to<int>(wstr));
+    stats_block block_;
+};
+
+class stat_scope {
+   public:
+    explicit stat_scope(stat_kind kind) : kind_(local_stats::kind()) {
+        local_stats::block().add(kind, stats_block::calls, 1);
+        local_stats::kind() = kind;
+        ++local_stats::depth();
     }
 
-    operator unsigned char() const { return value_; }
+    ~stat_scope() {
+        --local_stats::depth();
+        local_stats::kind() = kind_;
+    }
 
    private:
-    unsigned char value_;
+    stat_scope(const stat_scope&);
+    stat_scope& operator=(const stat_scope&);
+
+    int kind_;
 };
 
-//-----------------------------------------------------------------------------
+inline void count_stat(stats_block::field f) {
+    if (local_stats::depth() > 0) {
+        local_stats::block().add(local_stats::kind(), f, 1);
+    }
+}
 
-template <>
-class to<bool> {
-   public:
-    template <typename T>
-    explicit to(const T& value) {
-        value_ = static_cast<bool>(value);
+inline void record_allocation(size_t size) {
+    if (local_stats::depth() > 0) {
+        stats_block& block = local_stats::block();
+        block.add(local_stats::kind(), stats_block::allocations, 1);
+        block.add(local_stats::kind(), stats_block::allocated_bytes, size);
     }
+}
 
-    explicit to(const char* str) { value_ = !std::string(str).empty(); }
-    explicit to(const std::string& str) { value_ = !str.empty(); }
+#define CONV_STAT_SCOPE(kind) \
+    ::conv::internal::stat_scope conv_stat_scope_(::conv::kind)
+#define CONV_STAT_COUNT(field) \
+    ::conv::internal::count_stat(::conv::internal::stats_block::field)
+
+#define CONV_DEFINE_ALLOCATION_HOOKS                                     \
+    void* operator new(std::size_t size) {                               \
+        ::conv::internal::record_allocation(size);                       \
+        if (void* p = std::malloc(size ? size : 1)) {                    \
+            return p;                                                    \
+        }                                                                \
+        throw std::bad_alloc();                                          \
+    }                                                                    \
+    void* operator new[](std::size_t size) {                             \
+        ::conv::internal::record_allocation(size);                       \
+        if (void* p = std::malloc(size ? size : 1)) {                    \
+            return p;                                                    \
+        }                                                                \
+        throw std::bad_alloc();                                          \
+    }                                                                    \
+    void operator delete(void* p) noexcept { std::free(p); }             \
+    void operator delete[](void* p) noexcept { std::free(p); }           \
+    void operator delete(void* p, std::size_t) noexcept { std::free(p); } \
+    void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#else
+#define CONV_STAT_SCOPE(kind) ((void)0)
+#define CONV_STAT_COUNT(field) ((void)0)
+#endif
 
-    explicit to(const wchar_t* wstr) { value_ = !std::wstring(wstr).empty(); }
-    explicit to(const std::wstring& wstr) { value_ = !wstr.empty(); }
+}  // namespace internal
 
-    operator bool() const { return value_; }
+inline conversion_stats stats() {
+#if defined(CONV_ENABLE_STATS)
+    return internal::stats_registry::instance().collect();
+#else
+    return conversion_stats();
+#endif
+}
 
-   private:
-    bool value_;
-};
+inline void reset_stats() {
+#if defined(CONV_ENABLE_STATS)
+    internal::stats_registry::instance().reset();
+#endif
+}
 
 //-----------------------------------------------------------------------------
 
-template <>
-class to<std::string> : public std::string {
+struct latency_summary {
+    std::string name;
+    unsigned long long count;
+    unsigned long long p50;
+    unsigned long long p99;
+    unsigned long long p999;
+    unsigned long long max;
+};
+
+namespace internal {
+
+#if defined(CONV_ENABLE_LATENCY)
+class latency_histogram {
    public:
-    template <typename U>
-    explicit to(const U& value) {
-        std::ostringstream out;
-        out << value;
-        std::string::operator=(out.str());
+    static const unsigned sub_bits = 5;
+    static const unsigned max_shift = 34;
+    static const size_t bucket_count = (max_shift + 2) << sub_bits;
+
+    latency_histogram() { clear(); }
+
+    static size_t bucket(unsigned long long ns) {
+        const unsigned long long limit =
+            (2ULL << (max_shift + sub_bits)) - 1;
+
+        if (ns > limit) {
+            ns = limit;
+        }
+
+        unsigned width = 0;
+
+        for (unsigned long long x = ns; x; x >>= 1) {
+            ++width;
+        }
+
+        unsigned shift = width > sub_bits + 1 ? width - sub_bits - 1 : 0;
+        return (static_cast<size_t>(shift) << sub_bits) +
+               static_cast<size_t>(ns >> shift);
     }
 
-    explicit to(char value) { from_int8(value); }
-    explicit to(signed char value) { from_int8(value); }
-    explicit to(unsigned char value) { from_int8(value); }
+    static unsigned long long upper_bound(size_t i) {
+        if (i < (2U << sub_bits)) {
+            return i;
+        }
 
-    explicit to(bool value) {
-        value ? std::string::operator=("true") : std::string::operator=(
-                                                     "false");
+        unsigned shift = static_cast<unsigned>(i >> sub_bits) - 1;
+        unsigned long long m = (i & ((1U << sub_bits) - 1)) + (1U << sub_bits);
+        return ((m + 1) << shift) - 1;
     }
 
-    explicit to(const char* str) : std::string(str) {}
-    explicit to(const std::string& str) : std::string(str) {}
+    void record(unsigned long long ns) {
+        std::atomic<unsigned long long>& c = counts_[bucket(ns)];
+        c.store(c.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    }
 
-    explicit to(const wchar_t* wstr) { from_wstring(wstr); }
-    explicit to(const std::wstring& wstr) { from_wstring(wstr); }
+    void add_to(std::vector<unsigned long long>& counts) const {
+        counts.resize(bucket_count);
 
-   private:
-    void from_int8(int value) {
-        std::ostringstream out;
-        out << value;
-        std::string::operator=(out.str());
+        for (size_t i = 0; i < bucket_count; ++i) {
+            counts[i] += counts_[i].load(std::memory_order_relaxed);
+        }
     }
 
-    void from_wstring(const std::wstring& wstr) {
-        std::vector<char> mbs(wstr.size() * MB_CUR_MAX + 1);
-        std::wcstombs(mbs.data(), wstr.data(), mbs.size());
-        std::string::operator=(mbs.data());
+    void clear() {
+        for (size_t i = 0; i < bucket_count; ++i) {
+            counts_[i].store(0, std::memory_order_relaxed);
+        }
     }
-};
 
-//-----------------------------------------------------------------------------
+   private:
+    std::atomic<unsigned long long> counts_[bucket_count];
+};
 
-template <>
-class to<std::wstring> : public std::wstring {
+class latency_table {
    public:
-    template <typename U>
-    explicit to(const U& value) {
-        std::wostringstream out;
-        out << value;
-        std::wstring::operator=(out.str());
-    }
+    latency_histogram& get(size_t id);
 
-    explicit to(char value) { from_int8(value); }
-    explicit to(signed char value) { from_int8(value); }
-    explicit to(unsigned char value) { from_int8(value); }
+    void add_to(std::vector<std::vector<unsigned long long> >& counts) const {
+        if (counts.size() < histograms_.size()) {
+            counts.resize(histograms_.size());
+        }
 
-    explicit to(bool value) {
-        value ? std::wstring::operator=(L"true") : std::wstring::operator=(
-                                                       L"false");
+        for (size_t i = 0; i < histograms_.size(); ++i) {
+            if (histograms_[i]) {
+                histograms_[i]->add_to(counts[i]);
+            }
+        }
     }
 
-    explicit to(const char* str) { from_string(str); }
-    explicit to(const std::string& str) { from_string(str); }
-
-    explicit to(const wchar_t* wstr) : std::wstring(wstr) {}
-    explicit to(const std::wstring& wstr) : std::wstring(wstr) {}
+    void clear() {
+        for (size_t i = 0; i < histograms_.size(); ++i) {
+            if (histograms_[i]) {
+                histograms_[i]->clear();
+            }
+        }
+    }
 
    private:
-    void from_int8(int value) {
-        std::wostringstream out;
-        out << value;
-        std::wstring::operator=(out.str());
-    }
+    friend class latency_registry;
 
-    void from_string(const std::string& str) {
-        std::vector<wchar_t> wcs(str.size() + 1);
-        std::mbstowcs(wcs.data(), str.data(), wcs.size());
-        std::wstring::operator=(wcs.data());
-    }
+    std::vector<std::unique_ptr<latency_histogram> > histograms_;
 };
 
-//-----------------------------------------------------------------------------
-
-template <typename T1, typename T2>
-class to<std::pair<T1, T2> > : public std::pair<T1, T2> {
+class latency_registry {
    public:
-    template <typename U1, typename U2>
-    explicit to(const std::pair<U1, U2>& p) {
-        std::pair<T1, T2>::first = to<T1>(p.first);
-        std::pair<T1, T2>::second = to<T2>(p.second);
+    static latency_registry& instance() {
+        static latency_registry registry;
+        return registry;
     }
-};
 
-//-----------------------------------------------------------------------------
+    size_t add_name(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.push_back(name);
+        return names_.size() - 1;
+    }
 
-template <typename T>
-class to<std::vector<T> > : public std::vector<T> {
-   public:
-    template <typename U>
-    explicit to(const std::vector<U>& v)
-          : std::vector<T>(v.size()) {
-        for (size_t i = 0; i < v.size(); ++i) {
-            std::vector<T>::operator[](i) = to<T>(v[i]);
-        }
+    void attach(latency_table* table) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tables_.push_back(table);
     }
-};
 
-//-----------------------------------------------------------------------------
+    void detach(latency_table* table) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        table->add_to(retired_);
+        tables_.erase(std::find(tables_.begin(), tables_.end(), table));
+    }
 
-template <typename K1, typename V1>
-class to<std::map<K1, V1> > : public std::map<K1, V1> {
-   public:
-    template <typename K2, typename V2>
-    explicit to(const std::map<K2, V2>& m) {
-        typedef typename std::map<K2, V2>::const_iterator iterator;
+    latency_histogram& grow(latency_table& table, size_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
 
-        for (iterator iter = m.begin(); iter != m.end(); ++iter) {
-            std::map<K1, V1>::operator[](to<K1>(iter->first)) =
-                to<V1>(iter->second);
+        if (table.histograms_.size() <= id) {
+            table.histograms_.resize(id + 1);
         }
+
+        table.histograms_[id].reset(new latency_histogram());
+        return *table.histograms_[id];
     }
-};
 
-//-----------------------------------------------------------------------------
+    std::vector<latency_summary> collect() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::vector<unsigned long long> > counts = retired_;
 
-class parse_options {
-   public:
-    parse_options() : lbracket_("["), rbracket_("]"), comma_(",") {}
+        for (size_t i = 0; i < tables_.size(); ++i) {
+            tables_[i]->add_to(counts);
+        }
 
-    parse_options& lbracket(const std::string& s) {
-        lbracket_ = s;
-        return *this;
-    }
+        std::vector<latency_summary> result;
 
-    const std::string& lbracket() const { return lbracket_; }
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (!counts[i].empty()) {
+                summarize(names_[i], counts[i], result);
+            }
+        }
 
-    parse_options& rbracket(const std::string& s) {
-        rbracket_ = s;
-        return *this;
+        return result;
     }
 
-    const std::string& rbracket() const { return rbracket_; }
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_.clear();
 
-    parse_options& comma(const std::string& s) {
-        comma_ = s;
-        return *this;
+        for (size_t i = 0; i < tables_.size(); ++i) {
+            tables_[i]->clear();
+        }
     }
 
-    const std::string& comma() const { return comma_; }
-
    private:
-    std::string lbracket_;
-    std::string rbracket_;
-    std::string comma_;
-};
+    static void summarize(const std::string& name,
+                          const std::vector<unsigned long long>& counts,
+                          std::vector<latency_summary>& result) {
+        latency_summary summary;
+        summary.name = name;
+        summary.count = 0;
+        summary.max = 0;
+
+        for (size_t i = 0; i < counts.size(); ++i) {
+            summary.count += counts[i];
+
+            if (counts[i]) {
+                summary.max = latency_histogram::upper_bound(i);
+            }
+        }
 
-inline parse_options lbracket(const std::string& s) {
-    return parse_options().lbracket(s);
-}
+        if (summary.count == 0) {
+            return;
+        }
 
-inline parse_options rbracket(const std::string& s) {
-    return parse_options().rbracket(s);
-}
+        summary.p50 = percentile(counts, summary.count, 0.5);
+        summary.p99 = percentile(counts, summary.count, 0.99);
+        summary.p999 = percentile(counts, summary.count, 0.999);
+        result.push_back(summary);
+    }
 
-inline parse_options comma(const std::string& s) {
-    return parse_options().comma(s);
-}
+    static unsigned long long percentile(
+        const std::vector<unsigned long long>& counts,
+        unsigned long long total, double q) {
+        unsigned long long rank =
+            static_cast<unsigned long long>(q * static_cast<double>(total));
+        unsigned long long seen = 0;
 
-template <typename VecT>
-inline VecT parse(const std::string& str,
-                  const parse_options& opt = parse_options()) {
-    typedef char char_t;
-    typedef std::basic_string<char_t> string_t;
-    typedef typename VecT::value_type value_t;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
 
-    static const string_t& space = internal::space<char_t>();
+            if (seen > rank) {
+                return latency_histogram::upper_bound(i);
+            }
+        }
 
-    VecT vec;
+        return latency_histogram::upper_bound(counts.size() - 1);
+    }
 
-    size_t first = str.find_first_not_of(space);
-    assert(first != string_t::npos);
+    std::mutex mutex_;
+    std::vector<std::string> names_;
+    std::vector<latency_table*> tables_;
+    std::vector<std::vector<unsigned long long> > retired_;
+};
 
-    if (!opt.lbracket().empty()) {
-        assert(str[first] == opt.lbracket()[0]);
-        first = str.find_first_not_of(space, first + 1);
+inline latency_histogram& latency_table::get(size_t id) {
+    if (id < histograms_.size() && histograms_[id]) {
+        return *histograms_[id];
     }
 
-    size_t last = str.find_last_not_of(space);
-    assert(last != string_t::npos);
+    return latency_registry::instance().grow(*this, id);
+}
 
-    if (!opt.rbracket().empty()) {
-        assert(str[last] == opt.rbracket()[0]);
-        last = str.find_last_not_of(space, last - 1);
+class local_latency {
+   public:
+    static latency_table& table() {
+        static thread_local local_latency latency;
+        return latency.table_;
     }
 
-    assert(first <= last);
+   private:
+    local_latency() { latency_registry::instance().attach(&table_); }
+    ~local_latency() { latency_registry::instance().detach(&table_); }
 
-    std::string fields = str.substr(first, last - first + 1);
-    first = 0;
-    size_t pos = 0;
+    latency_table table_;
+};
 
-    while ((pos = fields.find_first_of(opt.comma(), first)) != string_t::npos) {
-        assert(first < pos);
+template <typename T>
+inline std::string type_name() {
+    std::string name = typeid(T).name();
 
-        value_t v = to<value_t>(fields.substr(first, pos - first));
-        vec.push_back(v);
-        first = pos + 1;
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled =
+        abi::__cxa_demangle(name.c_str(), NULL, NULL, &status);
+
+    if (status == 0) {
+        name = demangled;
     }
 
-    value_t v = to<value_t>(fields.substr(first));
-    vec.push_back(v);
+    std::free(demangled);
+#endif
+
+    static const char* const aliases[][2] = {
+        {"std::__cxx11::basic_string<char, std::char_traits<char>, "
+         "std::allocator<char> >",
+         "std::string"},
+        {"std::__cxx11::basic_string<wchar_t, std::char_traits<wchar_t>, "
+         "std::allocator<wchar_t> >",
+         "std::wstring"},
+        {"std::basic_string<char, std::char_traits<char>, "
+         "std::allocator<char> >",
+         "std::string"},
+        {"std::basic_string<wchar_t, std::char_traits<wchar_t>, "
+         "std::allocator<wchar_t> >",
+         "std::wstring"},
+    };
+
+    for (size_t i = 0; i < sizeof(aliases) / sizeof(aliases[0]); ++i) {
+        const std::string from(aliases[i][0]);
+        size_t pos;
+
+        while ((pos = name.find(from)) != std::string::npos) {
+            name.replace(pos, from.size(), aliases[i][1]);
+        }
+    }
 
-    return vec;
+    return name;
 }
 
-//-----------------------------------------------------------------------------
+struct to_op {};
+struct parse_op {};
 
-template <typename T>
-inline std::ostream& operator<<(std::ostream& out, const to<T>& value) {
-    out << static_cast<T>(value);
-    return out;
+template <typename From, typename To>
+inline std::string latency_name(to_op) {
+    return "to<" + type_name<To>() + ">(" + type_name<From>() + ")";
+}
+
+template <typename From, typename To>
+inline std::string latency_name(parse_op) {
+    return "parse<" + type_name<To>() + ">";
+}
+
+template <typename Op, typename From, typename To>
+inline size_t latency_id() {
+    static const size_t id =
+        latency_registry::instance().add_name(latency_name<From, To>(Op()));
+    return id;
+}
+
+template <typename Op, typename From, typename To>
+class latency_scope {
+   public:
+    latency_scope() : start_(std::chrono::steady_clock::now()) {}
+
+    ~latency_scope() {
+        std::chrono::steady_clock::duration elapsed =
+            std::chrono::steady_clock::now() - start_;
+
+        local_latency::table()
+            .get(latency_id<Op, From, To>())
+            .record(static_cast<unsigned long long>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count()));
+    }
+
+   private:
+    latency_scope(const latency_scope&);
+    latency_scope& operator=(const latency_scope&);
+
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define CONV_LATENCY_SCOPE(From, To)                                  \
+    ::conv::internal::latency_scope<::conv::internal::to_op, From, To> \
+        conv_latency_scope_
+#define CONV_PARSE_LATENCY_SCOPE(T)                                        \
+    ::conv::internal::latency_scope<::conv::internal::parse_op, std::string, \
+                                    T>                                     \
+        conv_latency_scope_
+#else
+#define CONV_LATENCY_SCOPE(From, To) ((void)0)
+#define CONV_PARSE_LATENCY_SCOPE(T) ((void)0)
+#endif
+
+}  // namespace internal
+
+inline std::vector<latency_summary> latencies() {
+#if defined(CONV_ENABLE_LATENCY)
+    return internal::latency_registry::instance().collect();
+#else
+    return std::vector<latency_summary>();
+#endif
+}
+
+inline void reset_latencies() {
+#if defined(CONV_ENABLE_LATENCY)
+    internal::latency_registry::instance().reset();
+#endif
+}
+
+inline void dump_latencies(std::ostream& out) {
+    std::vector<latency_summary> summaries = latencies();
+
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const latency_summary& s = summaries[i];
+        out << s.name << ": count " << s.count << ", p50 " << s.p50
+            << " ns, p99 " << s.p99 << " ns, p999 " << s.p999 << " ns, max "
+            << s.max << " ns\n";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+namespace internal {
+
+template <typename CharT>
+constexpr const CharT* space();
+
+template <>
+constexpr const char* space<char>() {
+    return " \t\v\r\n";
+}
+
+template <>
+constexpr const wchar_t* space<wchar_t>() {
+    return L" \t\v\r\n";
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename CharT>
+constexpr const CharT* hex();
+
+template <>
+constexpr const char* hex<char>() {
+    return "0x";
+}
+
+template <>
+constexpr const wchar_t* hex<wchar_t>() {
+    return L"0x";
+}
+
+//-----------------------------------------------------------------------------
+
+enum char_class {
+    space_class = 1,
+    digit_class = 2,
+    hex_class = 4,
+    delimiter_class = 8
+};
+
+// Delimiters are NUL and the ASCII punctuation characters that can separate
+// fields. '+', '-', '.' and '_' are left out as they appear inside numbers
+// and words.
+constexpr unsigned char classify(unsigned c) {
+    return static_cast<unsigned char>(
+        (c == ' ' || c == '\t' || c == '\v' || c == '\r' || c == '\n'
+             ? space_class
+             : 0) |
+        (c >= '0' && c <= '9' ? digit_class | hex_class : 0) |
+        ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F') ? hex_class : 0) |
+        (c == 0 || (((c >= '!' && c <= '/') || (c >= ':' && c <= '@') ||
+                     (c >= '[' && c <= '`') || (c >= '{' && c <= '~')) &&
+                    c != '+' && c != '-' && c != '.' && c != '_')
+             ? delimiter_class
+             : 0));
+}
+
+#define CONV_CLASSIFY_16(c)                                                    \
+    classify(c), classify(c + 1), classify(c + 2), classify(c + 3),            \
+        classify(c + 4), classify(c + 5), classify(c + 6), classify(c + 7),    \
+        classify(c + 8), classify(c + 9), classify(c + 10), classify(c + 11),  \
+        classify(c + 12), classify(c + 13), classify(c + 14), classify(c + 15)
+
+template <typename T = void>
+struct char_classes {
+    static constexpr unsigned char table[256] = {
+        CONV_CLASSIFY_16(0x00), CONV_CLASSIFY_16(0x10), CONV_CLASSIFY_16(0x20),
+        CONV_CLASSIFY_16(0x30), CONV_CLASSIFY_16(0x40), CONV_CLASSIFY_16(0x50),
+        CONV_CLASSIFY_16(0x60), CONV_CLASSIFY_16(0x70), CONV_CLASSIFY_16(0x80),
+        CONV_CLASSIFY_16(0x90), CONV_CLASSIFY_16(0xa0), CONV_CLASSIFY_16(0xb0),
+        CONV_CLASSIFY_16(0xc0), CONV_CLASSIFY_16(0xd0), CONV_CLASSIFY_16(0xe0),
+        CONV_CLASSIFY_16(0xf0)};
+};
+
+#undef CONV_CLASSIFY_16
+
+#if CONV_CPLUSPLUS < 201703L
+template <typename T>
+constexpr unsigned char char_classes<T>::table[256];
+#endif
+
+inline unsigned class_of(char c) {
+    return char_classes<>::table[static_cast<unsigned char>(c)];
+}
+
+template <typename CharT>
+inline unsigned class_of(CharT c) {
+    typedef typename std::make_unsigned<CharT>::type unsigned_t;
+    unsigned_t u = static_cast<unsigned_t>(c);
+    return u < 256 ? char_classes<>::table[u] : 0;
+}
+
+template <typename CharT>
+inline bool is_space(CharT c) {
+    return (class_of(c) & space_class) != 0;
+}
+
+template <typename CharT>
+inline void trim(const CharT*& first, const CharT*& last) {
+    while (first != last && is_space(*first)) {
+        ++first;
+    }
+
+    while (first != last && is_space(*(last - 1))) {
+        --last;
+    }
+}
+
+template <typename CharT>
+inline bool is_any_of(CharT c, const std::string& set) {
+    for (size_t i = 0; i < set.size(); ++i) {
+        if (c == static_cast<CharT>(set[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline unsigned popcount(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcount(x));
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+inline unsigned count_trailing_zeros(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(x));
+#else
+    unsigned n = 0;
+
+    for (; !(x & 1); x >>= 1) {
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+inline unsigned highest_bit(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - static_cast<unsigned>(__builtin_clz(x));
+#else
+    unsigned n = 0;
+
+    while (x >>= 1) {
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+#if defined(CONV_HAS_SSE2)
+inline size_t load_needles(__m128i (&needles)[4], const std::string& set) {
+    if (set.empty() || set.size() > 4) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < set.size(); ++i) {
+        needles[i] = _mm_set1_epi8(set[i]);
+    }
+
+    return set.size();
+}
+
+inline unsigned match_any(const char* p, const __m128i (&needles)[4],
+                          size_t size) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hits = _mm_cmpeq_epi8(chunk, needles[0]);
+
+    for (size_t i = 1; i < size; ++i) {
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[i]));
+    }
+
+    return static_cast<unsigned>(_mm_movemask_epi8(hits));
+}
+#endif
+
+inline size_t count_any_of(const char* first, const char* last,
+                           const std::string& set) {
+    size_t count = 0;
+
+    if (set.empty()) {
+        return count;
+    }
+
+#if defined(CONV_HAS_SSE2)
+    __m128i needles[4];
+
+    if (size_t size = load_needles(needles, set)) {
+        for (; last - first >= 16; first += 16) {
+            count += popcount(match_any(first, needles, size));
+        }
+    }
+#endif
+
+    for (; first != last; ++first) {
+        count += is_any_of(*first, set);
+    }
+
+    return count;
+}
+
+inline const char* find_any_of(const char* first, const char* last,
+                               const std::string& set) {
+    if (set.size() == 1) {
+        const void* pos = std::memchr(first, set[0], last - first);
+        return pos ? static_cast<const char*>(pos) : last;
+    }
+
+#if defined(CONV_HAS_SSE2)
+    __m128i needles[4];
+
+    if (size_t size = load_needles(needles, set)) {
+        for (; last - first >= 16; first += 16) {
+            if (unsigned mask = match_any(first, needles, size)) {
+                return first + count_trailing_zeros(mask);
+            }
+        }
+    }
+#endif
+
+    while (first != last && !is_any_of(*first, set)) {
+        ++first;
+    }
+
+    return first;
+}
+
+#if defined(CONV_HAS_SSE2)
+inline unsigned space_mask(const char* p) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')),
+                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\v')));
+    return static_cast<unsigned>(_mm_movemask_epi8(hits));
+}
+#endif
+
+inline void trim(const char*& first, const char*& last) {
+#if defined(CONV_HAS_SSE2)
+    while (last - first >= 16 && is_space(*first)) {
+        if (unsigned mask = ~space_mask(first) & 0xffff) {
+            first += count_trailing_zeros(mask);
+            break;
+        }
+
+        first += 16;
+    }
+
+    while (last - first >= 16 && is_space(*(last - 1))) {
+        if (unsigned mask = ~space_mask(last - 16) & 0xffff) {
+            last -= 15 - highest_bit(mask);
+            break;
+        }
+
+        last -= 16;
+    }
+#endif
+
+    while (first != last && is_space(*first)) {
+        ++first;
+    }
+
+    while (first != last && is_space(*(last - 1))) {
+        --last;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+struct is_number
+    : std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                       !std::is_same<T, bool>::value> {};
+
+template <typename CharT>
+inline int digit_value(CharT c) {
+    unsigned cls = class_of(c);
+
+    if (cls & digit_class) {
+        return static_cast<int>(c - '0');
+    }
+
+    if (cls & hex_class) {
+        return static_cast<int>((c | 0x20) - 'a' + 10);
+    }
+
+    return 16;
+}
+
+template <typename T, typename CharT>
+inline bool parse_integer(const CharT* first, const CharT* last, T& value) {
+    typedef typename std::make_unsigned<T>::type unsigned_t;
+
+    unsigned base = 10;
+    bool negative = false;
+
+    if (last - first >= 2 && first[0] == '0' && first[1] == 'x') {
+        base = 16;
+        first += 2;
+    } else if (first != last && (*first == '-' || *first == '+')) {
+        negative = *first == '-';
+        ++first;
+    }
+
+    const unsigned_t limit =
+        std::is_signed<T>::value
+            ? static_cast<unsigned_t>(std::numeric_limits<T>::max()) + negative
+            : std::numeric_limits<unsigned_t>::max();
+
+    const CharT* digits = first;
+    unsigned_t acc = 0;
+    bool overflow = false;
+
+    for (; first != last; ++first) {
+        unsigned d = static_cast<unsigned>(digit_value(*first));
+
+        if (d >= base) {
+            break;
+        }
+
+        if (acc > (limit - d) / base) {
+            overflow = true;
+        } else {
+            acc = acc * base + d;
+        }
+    }
+
+    if (first == digits) {
+        value = 0;
+        return false;
+    }
+
+    if (overflow) {
+        value = negative && std::is_signed<T>::value
+                    ? std::numeric_limits<T>::min()
+                    : std::numeric_limits<T>::max();
+        return false;
+    }
+
+    value = static_cast<T>(negative ? unsigned_t(0) - acc : acc);
+    return first == last;
+}
+
+// strtold and snprintf use the decimal point of the C locale. Swapping it
+// with '.' makes them read and write the classic format whatever
+// setlocale or std::locale::global installed. localeconv() is read once
+// per conversion; like strtold itself it must not race a setlocale() call
+// on another thread.
+inline void swap_decimal_point(char* first, char* last) {
+    const char* point = std::localeconv()->decimal_point;
+
+    if (point[0] == '.' || point[0] == '\0' || point[1] != '\0') {
+        return;
+    }
+
+    for (; first != last; ++first) {
+        if (*first == '.') {
+            *first = point[0];
+        } else if (*first == point[0]) {
+            *first = '.';
+        }
+    }
+}
+
+inline float strto_floating(const char* str, float) {
+    return std::strtof(str, NULL);
+}
+
+inline double strto_floating(const char* str, double) {
+    return std::strtod(str, NULL);
+}
+
+inline long double strto_floating(const char* str, long double) {
+    return std::strtold(str, NULL);
+}
+
+template <typename T>
+inline bool parse_floating(const char* first, const char* last, T& value) {
+    if (first != last && *first == '+') {
+        ++first;
+    }
+
+#if defined(CONV_HAS_FLOAT_CHARCONV)
+    std::from_chars_result result = std::from_chars(first, last, value);
+
+    if (result.ec == std::errc::invalid_argument) {
+        value = 0;
+        return false;
+    }
+
+    // from_chars leaves the value alone when it does not fit; saturate to
+    // infinity or zero the way strtod does.
+    if (result.ec == std::errc::result_out_of_range) {
+        std::string buf(first, result.ptr);
+        swap_decimal_point(&buf[0], &buf[0] + buf.size());
+        value = strto_floating(buf.c_str(), value);
+        return false;
+    }
+
+    return result.ec == std::errc() && result.ptr == last;
+#else
+    std::string buf(first, last);
+    swap_decimal_point(&buf[0], &buf[0] + buf.size());
+    char* end = NULL;
+    value = static_cast<T>(std::strtold(buf.c_str(), &end));
+    return end != buf.c_str() && *end == '\0';
+#endif
+}
+
+template <typename T>
+inline bool parse_floating(const wchar_t* first, const wchar_t* last,
+                           T& value) {
+    char buf[128];
+    size_t size = static_cast<size_t>(last - first);
+
+    if (size >= sizeof(buf)) {
+        value = 0;
+        return false;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        buf[i] = first[i] < 0x80 ? static_cast<char>(first[i]) : '?';
+    }
+
+    return parse_floating(buf, buf + size, value);
+}
+
+template <typename T, typename CharT>
+inline bool parse_number(const CharT* first, const CharT* last, T& value,
+                         std::true_type) {
+    if (sizeof(T) == 1) {
+        int wide = 0;
+        bool ok = parse_integer(first, last, wide);
+        value = static_cast<T>(wide);
+        return ok;
+    }
+
+    return parse_integer(first, last, value);
+}
+
+template <typename T, typename CharT>
+inline bool parse_number(const CharT* first, const CharT* last, T& value,
+                         std::false_type) {
+    return parse_floating(first, last, value);
+}
+
+template <typename T, typename CharT>
+inline bool read_value(const CharT* first, const CharT* last, T& value,
+                       std::true_type) {
+    return parse_number(first, last, value, std::is_integral<T>());
+}
+
+#if defined(CONV_HAS_INT128)
+// Decimal digits are read 19 at a time into 64 bits, and only whole chunks
+// are folded into the 128-bit accumulator.
+template <typename T, typename CharT>
+inline bool parse_int128(const CharT* first, const CharT* last, T& value,
+                         bool is_signed) {
+    unsigned base = 10;
+    bool negative = false;
+
+    if (last - first >= 2 && first[0] == '0' && first[1] == 'x') {
+        base = 16;
+        first += 2;
+    } else if (first != last && (*first == '-' || *first == '+')) {
+        negative = *first == '-';
+        ++first;
+    }
+
+    const uint128_t max = is_signed ? ~uint128_t(0) >> 1 : ~uint128_t(0);
+    const uint128_t limit = is_signed ? max + negative : max;
+
+    const CharT* digits = first;
+    uint128_t acc = 0;
+    bool overflow = false;
+
+    if (base == 16) {
+        for (; first != last; ++first) {
+            unsigned d = static_cast<unsigned>(digit_value(*first));
+
+            if (d >= 16) {
+                break;
+            }
+
+            if (acc > (limit - d) >> 4) {
+                overflow = true;
+            } else {
+                acc = (acc << 4) | d;
+            }
+        }
+    } else {
+        while (first != last) {
+            unsigned long long chunk = 0;
+            unsigned long long scale = 1;
+            unsigned n = 0;
+
+            for (; first != last && n < 19; ++first, ++n) {
+                unsigned d = static_cast<unsigned>(digit_value(*first));
+
+                if (d >= 10) {
+                    break;
+                }
+
+                chunk = chunk * 10 + d;
+                scale *= 10;
+            }
+
+            if (acc == 0) {
+                acc = chunk;
+            } else if (acc > (limit - chunk) / scale) {
+                overflow = true;
+            } else {
+                acc = acc * scale + chunk;
+            }
+
+            if (n < 19) {
+                break;
+            }
+        }
+    }
+
+    if (first == digits) {
+        value = 0;
+        return false;
+    }
+
+    if (overflow) {
+        value = static_cast<T>(negative && is_signed ? limit : max);
+        return false;
+    }
+
+    value = static_cast<T>(negative ? uint128_t(0) - acc : acc);
+    return first == last;
+}
+
+template <typename CharT>
+inline bool read_value(const CharT* first, const CharT* last,
+                       int128_t& value) {
+    return parse_int128(first, last, value, true);
+}
+
+template <typename CharT>
+inline bool read_value(const CharT* first, const CharT* last,
+                       uint128_t& value) {
+    return parse_int128(first, last, value, false);
+}
+#endif
+
+template <typename T>
+bool read_field(const char* first, const char* last, T& value);
+
+}  // namespace internal
+
+enum bool_vocabulary {
+    bool_true_false = 1,
+    bool_one_zero = 2,
+    bool_yes_no = 4,
+    bool_on_off = 8,
+    bool_any = 15
+};
+
+class source {
+   public:
+    source(const char* first, const char* last) : first_(first), last_(last) {}
+
+    const char* begin() const { return first_; }
+    const char* end() const { return last_; }
+    const char* data() const { return first_; }
+    size_t size() const { return static_cast<size_t>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+
+    std::string str() const { return std::string(first_, last_); }
+
+    template <typename T>
+    bool read(T& value) const {
+        return internal::read_field(first_, last_, value);
+    }
+
+   private:
+    const char* first_;
+    const char* last_;
+};
+
+//-----------------------------------------------------------------------------
+
+#if defined(CONV_HAS_CXX17)
+template <typename E>
+struct enum_entry {
+    E value;
+    std::string_view name;
+};
+
+namespace internal {
+
+template <typename E>
+struct has_enum_names {
+    template <typename U>
+    static std::true_type test(
+        decltype(conv_enum_names(std::declval<U>()), void())*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<E>(0))::value;
+};
+
+constexpr std::uint64_t name_hash(std::string_view s) {
+    std::uint64_t h = 14695981039346656037ull;
+
+    for (size_t i = 0; i < s.size(); ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+constexpr std::uint64_t mix_hash(std::uint64_t h, std::uint64_t seed) {
+    h ^= seed * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    return h ^ (h >> 33);
+}
+
+constexpr size_t ceil_pow2(size_t n) {
+    size_t p = 1;
+
+    while (p < n) {
+        p <<= 1;
+    }
+
+    return p;
+}
+
+// Hash and displace: a name falls into group mix_hash(h, 0), and each group
+// has a seed that sends all of its names to free slots with mix_hash(h, seed).
+// Groups are placed largest first.
+template <size_t N>
+struct perfect_hash {
+    static constexpr size_t group_count = ceil_pow2(N);
+    static constexpr size_t slot_count = ceil_pow2(N) * 2;
+
+    std::array<std::uint64_t, group_count> seeds;
+    std::array<size_t, slot_count> slots;  // entry + 1, 0 if free
+
+    constexpr size_t find(std::string_view s) const {
+        std::uint64_t h = name_hash(s);
+        std::uint64_t seed = seeds[mix_hash(h, 0) & (group_count - 1)];
+        return slots[mix_hash(h, seed) & (slot_count - 1)];
+    }
+};
+
+template <typename E, size_t N>
+constexpr perfect_hash<N> make_perfect_hash(
+    const std::array<enum_entry<E>, N>& names) {
+    typedef perfect_hash<N> hash_t;
+
+    hash_t ph{};
+    std::array<std::uint64_t, N> hashes{};
+    std::array<size_t, N> groups{};
+    std::array<size_t, hash_t::group_count> sizes{};
+
+    for (size_t i = 0; i < N; ++i) {
+        hashes[i] = name_hash(names[i].name);
+        groups[i] = mix_hash(hashes[i], 0) & (hash_t::group_count - 1);
+        ++sizes[groups[i]];
+
+        for (size_t j = 0; j < i; ++j) {
+            if (hashes[i] == hashes[j]) {
+                return ph;  // rejected by the static_assert in enum_table
+            }
+        }
+    }
+
+    for (size_t size = N; size > 0; --size) {
+        for (size_t g = 0; g < hash_t::group_count; ++g) {
+            if (sizes[g] != size) {
+                continue;
+            }
+
+            for (std::uint64_t seed = 1;; ++seed) {
+                std::array<size_t, N> placed{};
+                size_t count = 0;
+                bool free = true;
+
+                for (size_t i = 0; i < N && free; ++i) {
+                    if (groups[i] != g) {
+                        continue;
+                    }
+
+                    size_t slot =
+                        mix_hash(hashes[i], seed) & (hash_t::slot_count - 1);
+                    free = ph.slots[slot] == 0;
+
+                    for (size_t k = 0; k < count && free; ++k) {
+                        free = placed[k] != slot;
+                    }
+
+                    placed[count++] = slot;
+                }
+
+                if (free) {
+                    for (size_t i = 0, k = 0; i < N; ++i) {
+                        if (groups[i] == g) {
+                            ph.slots[placed[k++]] = i + 1;
+                        }
+                    }
+
+                    ph.seeds[g] = seed;
+                    break;
+                }
+            }
+        }
+    }
+
+    return ph;
+}
+
+template <typename E, size_t N>
+constexpr bool has_distinct_names(const std::array<enum_entry<E>, N>& names) {
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (name_hash(names[i].name) == name_hash(names[j].name)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename E, size_t N>
+constexpr bool is_dense(const std::array<enum_entry<E>, N>& names) {
+    typedef typename std::underlying_type<E>::type underlying_t;
+
+    for (size_t i = 0; i < N; ++i) {
+        if (static_cast<underlying_t>(names[i].value) !=
+            static_cast<underlying_t>(i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename E>
+struct enum_table {
+    static constexpr auto names = conv_enum_names(E());
+    static_assert(has_distinct_names(names),
+                  "conv_enum_names() lists the same name twice");
+    static constexpr auto hash = make_perfect_hash(names);
+    static constexpr bool dense = is_dense(names);
+};
+
+template <typename E>
+inline bool find_enum(std::string_view s, E& value) {
+    typedef enum_table<E> table_t;
+
+    if (size_t i = table_t::hash.find(s)) {
+        if (table_t::names[i - 1].name == s) {
+            value = table_t::names[i - 1].value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename E>
+inline std::string_view enum_name(E value) {
+    typedef enum_table<E> table_t;
+    typedef typename std::underlying_type<E>::type underlying_t;
+
+    if constexpr (table_t::dense) {
+        size_t i = static_cast<size_t>(static_cast<underlying_t>(value));
+        return i < table_t::names.size() ? table_t::names[i].name
+                                         : std::string_view();
+    } else {
+        for (size_t i = 0; i < table_t::names.size(); ++i) {
+            if (table_t::names[i].value == value) {
+                return table_t::names[i].name;
+            }
+        }
+
+        return std::string_view();
+    }
+}
+
+}  // namespace internal
+
+template <typename E, typename = typename std::enable_if<
+                          internal::has_enum_names<E>::value>::type>
+inline bool conv_parse(const source& in, E& value) {
+    typedef typename std::underlying_type<E>::type underlying_t;
+
+    if (internal::find_enum(std::string_view(in.data(), in.size()), value)) {
+        return true;
+    }
+
+    underlying_t n = 0;
+    bool ok =
+        internal::parse_number(in.begin(), in.end(), n, std::true_type());
+    value = static_cast<E>(n);
+    return ok;
+}
+#endif
+
+namespace internal {
+
+// A word holds up to 8 characters, the first one in the lowest byte.
+// The fold mask sets the case bit of the letters so that uppercase input
+// compares equal to the lowercase word.
+constexpr unsigned long long pack_word(const char* s, unsigned shift = 0) {
+    return *s ? (static_cast<unsigned long long>(
+                     static_cast<unsigned char>(*s))
+                 << shift) |
+                    pack_word(s + 1, shift + 8)
+              : 0;
+}
+
+constexpr unsigned long long fold_mask(const char* s, unsigned shift = 0) {
+    return *s ? ((*s >= 'a' && *s <= 'z' ? 0x20ull : 0ull) << shift) |
+                    fold_mask(s + 1, shift + 8)
+              : 0;
+}
+
+struct bool_word {
+    unsigned long long word;
+    unsigned long long fold;
+    unsigned size;
+    unsigned vocabulary;
+    bool value;
+};
+
+#define CONV_BOOL_WORD(s, vocabulary, value) \
+    { pack_word(s), fold_mask(s), sizeof(s) - 1, vocabulary, value }
+
+template <typename T = void>
+struct bool_words {
+    static constexpr bool_word table[8] = {
+        CONV_BOOL_WORD("true", bool_true_false, true),
+        CONV_BOOL_WORD("false", bool_true_false, false),
+        CONV_BOOL_WORD("1", bool_one_zero, true),
+        CONV_BOOL_WORD("0", bool_one_zero, false),
+        CONV_BOOL_WORD("yes", bool_yes_no, true),
+        CONV_BOOL_WORD("no", bool_yes_no, false),
+        CONV_BOOL_WORD("on", bool_on_off, true),
+        CONV_BOOL_WORD("off", bool_on_off, false)};
+};
+
+#undef CONV_BOOL_WORD
+
+#if CONV_CPLUSPLUS < 201703L
+template <typename T>
+constexpr bool_word bool_words<T>::table[8];
+#endif
+
+inline unsigned long long load_word(const char* p, size_t size) {
+    unsigned long long word = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        word |= static_cast<unsigned long long>(static_cast<unsigned char>(p[i]))
+                << (8 * i);
+    }
+
+    return word;
+}
+
+inline bool parse_bool(const char* first, const char* last,
+                       unsigned vocabulary, bool& value) {
+    size_t size = static_cast<size_t>(last - first);
+    value = false;
+
+    if (size == 0 || size > 5) {
+        return false;
+    }
+
+    unsigned long long word = load_word(first, size);
+
+    for (size_t i = 0; i < 8; ++i) {
+        const bool_word& w = bool_words<>::table[i];
+
+        if ((w.vocabulary & vocabulary) && w.size == size &&
+            (word | w.fold) == w.word) {
+            value = w.value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline bool parse_bool(const wchar_t* first, const wchar_t* last,
+                       unsigned vocabulary, bool& value) {
+    char buf[8];
+    size_t size = static_cast<size_t>(last - first);
+    value = false;
+
+    if (size > 5) {
+        return false;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        if (static_cast<unsigned long>(first[i]) >= 0x80) {
+            return false;
+        }
+
+        buf[i] = static_cast<char>(first[i]);
+    }
+
+    return parse_bool(buf, buf + size, vocabulary, value);
+}
+
+template <typename T>
+struct has_conv_parse {
+    template <typename U>
+    static std::true_type test(
+        decltype(conv_parse(std::declval<const source&>(), std::declval<U&>()),
+                 void())*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+template <typename T, typename CharT>
+inline bool read_stream(const CharT* first, const CharT* last, T& value,
+                        std::true_type) {
+    const source src(first, last);
+    return conv_parse(src, value);
+}
+
+template <typename T, typename CharT>
+inline bool read_stream(const CharT* first, const CharT* last, T& value,
+                        const std::locale& loc) {
+    typedef std::basic_string<CharT> string_t;
+    typedef std::basic_istringstream<CharT> isstream_t;
+
+    const CharT* hex = internal::hex<CharT>();
+
+    CONV_STAT_COUNT(streams);
+    CONV_STAT_COUNT(stream_fallbacks);
+    isstream_t in(string_t(first, last));
+    in.imbue(loc);
+
+    if (last - first >= 2 && first[0] == hex[0] && first[1] == hex[1]) {
+        in >> std::hex >> value;
+    } else {
+        in >> value;
+    }
+
+    return !in.fail();
+}
+
+template <typename T, typename CharT>
+inline bool read_stream(const CharT* first, const CharT* last, T& value,
+                        std::false_type) {
+    return read_stream(first, last, value, std::locale::classic());
+}
+
+template <typename T, typename CharT>
+inline bool read_value(const CharT* first, const CharT* last, T& value,
+                       std::false_type) {
+    return read_stream(
+        first, last, value,
+        std::integral_constant<bool, has_conv_parse<T>::value &&
+                                         std::is_same<CharT, char>::value>());
+}
+
+template <typename T, typename CharT>
+inline bool read_value(const CharT* first, const CharT* last, T& value) {
+    return read_value(first, last, value, is_number<T>());
+}
+
+}  // namespace internal
+
+//-----------------------------------------------------------------------------
+
+template <typename T1, typename T2>
+std::ostream& operator<<(std::ostream& out, const std::pair<T1, T2>& p);
+
+template <typename T1, typename T2>
+std::wostream& operator<<(std::wostream& out, const std::pair<T1, T2>& p);
+
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const std::vector<T>& v);
+
+template <typename T>
+std::wostream& operator<<(std::wostream& out, const std::vector<T>& v);
+
+template <typename K, typename V>
+std::ostream& operator<<(std::ostream& out, const std::map<K, V>& m);
+
+template <typename K, typename V>
+std::wostream& operator<<(std::wostream& out, const std::map<K, V>& m);
+
+template <typename CharT, typename Traits, typename T, typename Alloc>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out, const std::deque<T, Alloc>& d);
+
+template <typename CharT, typename Traits, typename T, typename Alloc>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out, const std::list<T, Alloc>& l);
+
+template <typename CharT, typename Traits, typename T, typename Compare,
+          typename Alloc>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::set<T, Compare, Alloc>& s);
+
+template <typename CharT, typename Traits, typename T, typename Hash,
+          typename Pred, typename Alloc>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::unordered_set<T, Hash, Pred, Alloc>& s);
+
+template <typename CharT, typename Traits, typename K, typename V,
+          typename Hash, typename Pred, typename Alloc>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::unordered_map<K, V, Hash, Pred, Alloc>& m);
+
+#if defined(CONV_HAS_FLAT_MAP)
+template <typename CharT, typename Traits, typename K, typename V,
+          typename Compare, typename KeyContainer, typename MappedContainer>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::flat_map<K, V, Compare, KeyContainer, MappedContainer>& m);
+#endif
+
+#if defined(CONV_HAS_FLAT_SET)
+template <typename CharT, typename Traits, typename T, typename Compare,
+          typename KeyContainer>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::flat_set<T, Compare, KeyContainer>& s);
+#endif
+
+//-----------------------------------------------------------------------------
+
+namespace internal {
+
+template <typename T>
+struct is_pair : std::false_type {};
+
+template <typename T1, typename T2>
+struct is_pair<std::pair<T1, T2> > : std::true_type {};
+
+enum container_kind {
+    no_container,
+    sequence_container,
+    set_container,
+    map_container
+};
+
+template <int Kind, bool Reservable, bool Sorted, bool Flat = false>
+struct container_category {
+    static const int kind = Kind;
+    static const bool reservable = Reservable;
+    static const bool sorted = Sorted;
+    static const bool flat = Flat;
+};
+
+template <typename T>
+struct container_traits : container_category<no_container, false, false> {};
+
+template <typename T, typename Alloc>
+struct container_traits<std::vector<T, Alloc> >
+    : container_category<sequence_container, true, false> {};
+
+template <typename T, typename Alloc>
+struct container_traits<std::deque<T, Alloc> >
+    : container_category<sequence_container, false, false> {};
+
+template <typename T, typename Alloc>
+struct container_traits<std::list<T, Alloc> >
+    : container_category<sequence_container, false, false> {};
+
+template <typename T, typename Compare, typename Alloc>
+struct container_traits<std::set<T, Compare, Alloc> >
+    : container_category<set_container, false, true> {};
+
+template <typename T, typename Hash, typename Pred, typename Alloc>
+struct container_traits<std::unordered_set<T, Hash, Pred, Alloc> >
+    : container_category<set_container, true, false> {};
+
+template <typename K, typename V, typename Compare, typename Alloc>
+struct container_traits<std::map<K, V, Compare, Alloc> >
+    : container_category<map_container, false, true> {};
+
+template <typename K, typename V, typename Hash, typename Pred, typename Alloc>
+struct container_traits<std::unordered_map<K, V, Hash, Pred, Alloc> >
+    : container_category<map_container, true, false> {};
+
+#if defined(CONV_HAS_FLAT_MAP)
+template <typename K, typename V, typename Compare, typename KeyContainer,
+          typename MappedContainer>
+struct container_traits<
+    std::flat_map<K, V, Compare, KeyContainer, MappedContainer> >
+    : container_category<map_container, false, true, true> {};
+#endif
+
+#if defined(CONV_HAS_FLAT_SET)
+template <typename T, typename Compare, typename KeyContainer>
+struct container_traits<std::flat_set<T, Compare, KeyContainer> >
+    : container_category<set_container, false, true, true> {};
+#endif
+
+template <typename T>
+struct container_tag
+    : std::integral_constant<int, container_traits<T>::kind> {};
+
+template <typename T>
+struct is_tuple : std::false_type {};
+
+template <typename... Ts>
+struct is_tuple<std::tuple<Ts...> > : std::true_type {};
+
+template <typename T>
+struct is_array : std::false_type {};
+
+template <typename T, size_t N>
+struct is_array<std::array<T, N> > : std::true_type {};
+
+template <typename T>
+struct is_optional : std::false_type {};
+
+template <typename T>
+struct is_variant : std::false_type {};
+
+#if defined(CONV_HAS_CXX17)
+template <typename T>
+struct is_optional<std::optional<T> > : std::true_type {};
+
+template <typename... Ts>
+struct is_variant<std::variant<Ts...> > : std::true_type {};
+#endif
+
+template <typename T>
+struct is_composite
+    : std::integral_constant<bool, container_traits<T>::kind != no_container ||
+                                       is_pair<T>::value || is_tuple<T>::value ||
+                                       is_array<T>::value ||
+                                       is_optional<T>::value ||
+                                       is_variant<T>::value> {};
+
+template <typename T>
+struct max_formatted_size
+    : std::integral_constant<size_t,
+                             std::is_integral<T>::value
+                                 ? std::numeric_limits<T>::digits10 + 2
+                                 : std::is_floating_point<T>::value ? 16 : 0> {
+};
+
+inline void append_literal(std::string& out, const char* s) { out.append(s); }
+
+inline void append_literal(std::wstring& out, const char* s) {
+    for (; *s; ++s) {
+        out.push_back(static_cast<wchar_t>(*s));
+    }
+}
+
+template <typename T>
+inline char* write_unsigned(char* end, T value) {
+    static const char pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    while (value >= 100) {
+        unsigned i = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--end = pairs[i + 1];
+        *--end = pairs[i];
+    }
+
+    if (value >= 10) {
+        unsigned i = static_cast<unsigned>(value) * 2;
+        *--end = pairs[i + 1];
+        *--end = pairs[i];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+
+    return end;
+}
+
+#if defined(CONV_HAS_INT128)
+inline char* write_unsigned(char* end, uint128_t value) {
+    const unsigned long long chunk = 10000000000000000000ULL;
+
+    while (value > std::numeric_limits<unsigned long long>::max()) {
+        char* first =
+            write_unsigned(end, static_cast<unsigned long long>(value % chunk));
+        value /= chunk;
+
+        while (end - first < 19) {
+            *--first = '0';
+        }
+
+        end = first;
+    }
+
+    return write_unsigned(end, static_cast<unsigned long long>(value));
+}
+#endif
+
+template <typename T>
+inline char* write_integer(char* end, T value, bool& negative) {
+    typedef typename std::make_unsigned<T>::type unsigned_t;
+
+    unsigned_t u = static_cast<unsigned_t>(value);
+    negative = std::is_signed<T>::value && value < T(0);
+    return write_unsigned(end, negative ? unsigned_t(0) - u : u);
+}
+
+#if defined(CONV_HAS_INT128)
+inline char* write_integer(char* end, int128_t value, bool& negative) {
+    uint128_t u = static_cast<uint128_t>(value);
+    negative = value < 0;
+    return write_unsigned(end, negative ? uint128_t(0) - u : u);
+}
+
+inline char* write_integer(char* end, uint128_t value, bool& negative) {
+    negative = false;
+    return write_unsigned(end, value);
+}
+#endif
+
+template <typename CharT, typename T>
+inline void append_integer(std::basic_string<CharT>& out, T value) {
+    typedef typename std::make_unsigned<T>::type unsigned_t;
+
+    char buf[std::numeric_limits<T>::digits10 + 3];
+    char* last = buf + sizeof(buf);
+
+    unsigned_t u = static_cast<unsigned_t>(value);
+    bool negative = std::is_signed<T>::value && value < T(0);
+
+    if (negative) {
+        u = unsigned_t(0) - u;
+    }
+
+    char* first = write_unsigned(last, u);
+
+    if (negative) {
+        *--first = '-';
+    }
+
+    out.append(first, last);
+}
+
+template <typename T>
+inline size_t write_floating(char (&buf)[64], T value) {
+#if defined(CONV_HAS_FLOAT_CHARCONV)
+    std::to_chars_result result = std::to_chars(
+        buf, buf + sizeof(buf), value, std::chars_format::general, 6);
+    return static_cast<size_t>(result.ptr - buf);
+#else
+    size_t size = static_cast<size_t>(std::snprintf(
+        buf, sizeof(buf), "%.6Lg", static_cast<long double>(value)));
+    swap_decimal_point(buf, buf + size);
+    return size;
+#endif
+}
+
+template <typename CharT, typename T>
+inline void append_floating(std::basic_string<CharT>& out, T value) {
+    char buf[64];
+    size_t size = write_floating(buf, value);
+    out.append(buf, buf + size);
+}
+
+template <typename CharT, typename T>
+inline void append_number(std::basic_string<CharT>& out, T value,
+                          std::true_type) {
+    append_integer(out, value);
+}
+
+template <typename CharT, typename T>
+inline void append_number(std::basic_string<CharT>& out, T value,
+                          std::false_type) {
+    append_floating(out, value);
+}
+
+template <typename CharT, typename T>
+inline void format_scalar(std::basic_string<CharT>& out, const T& value,
+                          std::true_type) {
+    append_number(out, value, std::is_integral<T>());
+}
+
+template <typename CharT>
+class string_streambuf : public std::basic_streambuf<CharT> {
+   public:
+    typedef std::basic_streambuf<CharT> base_t;
+    typedef typename base_t::traits_type traits_type;
+    typedef typename base_t::int_type int_type;
+
+    string_streambuf() : str_(NULL) {}
+
+    void attach(std::basic_string<CharT>* str) { str_ = str; }
+
+   protected:
+    int_type overflow(int_type c) {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+
+        str_->push_back(traits_type::to_char_type(c));
+        return c;
+    }
+
+    std::streamsize xsputn(const CharT* s, std::streamsize n) {
+        str_->append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+   private:
+    std::basic_string<CharT>* str_;
+};
+
+template <typename CharT>
+class scratch_stream {
+   public:
+    scratch_stream() : stream_(&buf_), busy_(false) {
+        CONV_STAT_COUNT(streams);
+        stream_.imbue(std::locale::classic());
+    }
+
+    static scratch_stream& local() {
+        static thread_local scratch_stream stream;
+        return stream;
+    }
+
+    class lease {
+       public:
+        lease(scratch_stream& owner, std::basic_string<CharT>& out)
+              : owner_(owner.busy_ ? NULL : &owner) {
+            if (owner_) {
+                owner_->busy_ = true;
+                owner_->reset(out);
+            } else {
+                fallback_.reset(new scratch_stream());
+                fallback_->reset(out);
+            }
+        }
+
+        ~lease() {
+            scratch_stream* s = owner_ ? owner_ : fallback_.get();
+            s->buf_.attach(NULL);
+
+            if (owner_) {
+                owner_->busy_ = false;
+            }
+        }
+
+        std::basic_ostream<CharT>& stream() {
+            return owner_ ? owner_->stream_ : fallback_->stream_;
+        }
+
+       private:
+        lease(const lease&);
+        lease& operator=(const lease&);
+
+        scratch_stream* owner_;
+        std::unique_ptr<scratch_stream> fallback_;
+    };
+
+   private:
+    scratch_stream(const scratch_stream&);
+    scratch_stream& operator=(const scratch_stream&);
+
+    // A user operator<< may have imbued a locale, set an exception mask or
+    // stored iword/pword data; copyfmt() from a pristine stream undoes all
+    // of it along with the flags, precision, width and fill.
+    void reset(std::basic_string<CharT>& out) {
+        buf_.attach(&out);
+        stream_.clear();
+        stream_.copyfmt(pristine());
+    }
+
+    class classic_ios : public std::basic_ios<CharT> {
+       public:
+        classic_ios() : std::basic_ios<CharT>(NULL) {
+            this->imbue(std::locale::classic());
+        }
+    };
+
+    static const std::basic_ios<CharT>& pristine() {
+        static const classic_ios ios;
+        return ios;
+    }
+
+    string_streambuf<CharT> buf_;
+    std::basic_ostream<CharT> stream_;
+    bool busy_;
+};
+
+template <typename CharT>
+class scratch_string {
+   public:
+    scratch_string() {
+        str_.swap(local());
+        str_.clear();
+    }
+
+    ~scratch_string() { str_.swap(local()); }
+
+    std::basic_string<CharT>& str() { return str_; }
+
+   private:
+    scratch_string(const scratch_string&);
+    scratch_string& operator=(const scratch_string&);
+
+    static std::basic_string<CharT>& local() {
+        static thread_local std::basic_string<CharT> str;
+        return str;
+    }
+
+    std::basic_string<CharT> str_;
+};
+
+template <typename CharT, typename T>
+inline void stream_value(std::basic_string<CharT>& out, const T& value) {
+    CONV_STAT_COUNT(stream_fallbacks);
+    typename scratch_stream<CharT>::lease lease(
+        scratch_stream<CharT>::local(), out);
+    lease.stream() << value;
+}
+
+template <typename CharT, typename T>
+inline void stream_value(std::basic_string<CharT>& out, const T& value,
+                         const std::locale& loc) {
+    CONV_STAT_COUNT(streams);
+    CONV_STAT_COUNT(stream_fallbacks);
+    string_streambuf<CharT> buf;
+    buf.attach(&out);
+    std::basic_ostream<CharT> stream(&buf);
+    stream.imbue(loc);
+    stream << value;
+}
+
+template <typename CharT, typename T>
+inline void format_scalar(std::basic_string<CharT>& out, const T& value,
+                          std::false_type) {
+    stream_value(out, value);
+}
+
+template <typename CharT, typename T>
+void format_value(std::basic_string<CharT>& out, const T& value);
+
+template <typename CharT>
+void format_value(std::basic_string<CharT>& out, bool value);
+
+void format_value(std::string& out, char value);
+void format_value(std::string& out, signed char value);
+void format_value(std::string& out, unsigned char value);
+void format_value(std::wstring& out, char value);
+
+#if defined(CONV_HAS_INT128)
+template <typename CharT>
+void format_value(std::basic_string<CharT>& out, int128_t value);
+
+template <typename CharT>
+void format_value(std::basic_string<CharT>& out, uint128_t value);
+#endif
+
+template <typename CharT, typename T>
+void format_value(std::basic_string<CharT>& out, const fixed_point<T>& f);
+
+template <typename CharT>
+void format_value(std::basic_string<CharT>& out, const CharT* str);
+
+template <typename CharT, typename Traits, typename Alloc>
+void format_value(std::basic_string<CharT>& out,
+                  const std::basic_string<CharT, Traits, Alloc>& str);
+
+template <typename CharT, typename T1, typename T2>
+void format_value(std::basic_string<CharT>& out, const std::pair<T1, T2>& p);
+
+#if defined(CONV_HAS_CXX17)
+template <typename CharT, typename... Ts>
+void format_value(std::basic_string<CharT>& out, const std::tuple<Ts...>& t);
+
+template <typename CharT, typename T, size_t N>
+void format_value(std::basic_string<CharT>& out, const std::array<T, N>& a);
+
+template <typename CharT, typename T>
+void format_value(std::basic_string<CharT>& out, const std::optional<T>& o);
+
+template <typename CharT, typename... Ts>
+void format_value(std::basic_string<CharT>& out,
+                  const std::variant<Ts...>& v);
+#endif
+
+inline unsigned bit_width(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? 64 - static_cast<unsigned>(__builtin_clzll(x)) : 0;
+#else
+    unsigned width = 0;
+
+    for (; x; x >>= 1) {
+        ++width;
+    }
+
+    return width;
+#endif
+}
+
+inline size_t count_digits(unsigned long long x) {
+    static const unsigned long long powers[] = {
+        0ULL,
+        10ULL,
+        100ULL,
+        1000ULL,
+        10000ULL,
+        100000ULL,
+        1000000ULL,
+        10000000ULL,
+        100000000ULL,
+        1000000000ULL,
+        10000000000ULL,
+        100000000000ULL,
+        1000000000000ULL,
+        10000000000000ULL,
+        100000000000000ULL,
+        1000000000000000ULL,
+        10000000000000000ULL,
+        100000000000000000ULL,
+        1000000000000000000ULL,
+        10000000000000000000ULL,
+    };
+
+    size_t t = (bit_width(x | 1) * 1233) >> 12;
+    return t - (x < powers[t]) + 1;
+}
+
+template <typename T>
+inline size_t integer_size(T value) {
+    typedef typename std::make_unsigned<T>::type unsigned_t;
+
+    unsigned_t u = static_cast<unsigned_t>(value);
+
+    if (std::is_signed<T>::value && value < T(0)) {
+        return count_digits(unsigned_t(0) - u) + 1;
+    }
+
+    return count_digits(u);
+}
+
+template <typename T>
+inline size_t floating_size(T value) {
+    char buf[64];
+    return write_floating(buf, value);
+}
+
+template <typename T>
+inline size_t number_size(T value, std::true_type) {
+    return integer_size(value);
+}
+
+template <typename T>
+inline size_t number_size(T value, std::false_type) {
+    return floating_size(value);
+}
+
+template <typename T>
+inline size_t scalar_size(const T& value, std::true_type) {
+    return number_size(value, std::is_integral<T>());
+}
+
+template <typename T>
+inline size_t scalar_size(const T& value, std::false_type) {
+    std::string buf;
+    format_value(buf, value);
+    return buf.size();
+}
+
+template <typename T>
+size_t element_size(const T& value);
+
+inline size_t element_size(bool);
+inline size_t element_size(char);
+inline size_t element_size(signed char);
+inline size_t element_size(unsigned char);
+inline size_t element_size(const char* str);
+
+#if defined(CONV_HAS_INT128)
+inline size_t element_size(int128_t value);
+inline size_t element_size(uint128_t value);
+#endif
+
+template <typename Traits, typename Alloc>
+size_t element_size(const std::basic_string<char, Traits, Alloc>& str);
+
+template <typename T1, typename T2>
+size_t element_size(const std::pair<T1, T2>& p);
+
+template <typename T>
+inline size_t container_size(const T& value,
+                             std::integral_constant<int, no_container>) {
+    return scalar_size(value, is_number<T>());
+}
+
+template <typename C>
+inline size_t range_size(const C& c) {
+    typedef typename C::const_iterator iterator;
+
+    if (c.empty()) {
+        return 0;
+    }
+
+    size_t size = c.size() * 2;
+
+    for (iterator iter = c.begin(); iter != c.end(); ++iter) {
+        size += element_size(*iter);
+    }
+
+    return size;
+}
+
+template <typename C>
+inline size_t container_size(const C& c,
+                             std::integral_constant<int, sequence_container>) {
+    return range_size(c);
+}
+
+template <typename C>
+inline size_t container_size(const C& c,
+                             std::integral_constant<int, set_container>) {
+    return range_size(c);
+}
+
+template <typename C>
+inline size_t container_size(const C& m,
+                             std::integral_constant<int, map_container>) {
+    typedef typename C::const_iterator iterator;
+
+    if (m.empty()) {
+        return 0;
+    }
+
+    size_t size = m.size() * 4;
+
+    for (iterator iter = m.begin(); iter != m.end(); ++iter) {
+        size += element_size(iter->first) + element_size(iter->second);
+    }
+
+    return size;
+}
+
+template <typename T>
+inline size_t element_size(const T& value) {
+    return container_size(value, container_tag<T>());
+}
+
+inline size_t element_size(bool) { return 1; }
+inline size_t element_size(char) { return 1; }
+inline size_t element_size(signed char) { return 1; }
+inline size_t element_size(unsigned char) { return 1; }
+
+inline size_t element_size(const char* str) {
+    return std::char_traits<char>::length(str);
+}
+
+#if defined(CONV_HAS_INT128)
+inline size_t element_size(uint128_t value) {
+    size_t size = 0;
+
+    for (; value > std::numeric_limits<unsigned long long>::max(); size += 19) {
+        value /= 10000000000000000000ULL;
+    }
+
+    return size + count_digits(static_cast<unsigned long long>(value));
+}
+
+inline size_t element_size(int128_t value) {
+    uint128_t u = static_cast<uint128_t>(value);
+    return value < 0 ? element_size(uint128_t(0) - u) + 1 : element_size(u);
+}
+#endif
+
+template <typename Traits, typename Alloc>
+inline size_t element_size(const std::basic_string<char, Traits, Alloc>& str) {
+    return str.size();
+}
+
+template <typename T1, typename T2>
+inline size_t element_size(const std::pair<T1, T2>& p) {
+    return element_size(p.first) + element_size(p.second) + 4;
+}
+
+}  // namespace internal
+
+template <typename CharT>
+class basic_sink {
+   public:
+    explicit basic_sink(std::basic_string<CharT>& str) : str_(str) {}
+
+    basic_sink& append(const CharT* s, size_t n) {
+        str_.append(s, n);
+        return *this;
+    }
+
+    basic_sink& put(CharT c) {
+        str_.push_back(c);
+        return *this;
+    }
+
+    basic_sink& operator<<(const CharT* s) {
+        str_.append(s);
+        return *this;
+    }
+
+    template <typename T>
+    basic_sink& operator<<(const T& value) {
+        internal::format_value(str_, value);
+        return *this;
+    }
+
+    std::basic_string<CharT>& str() { return str_; }
+
+   private:
+    std::basic_string<CharT>& str_;
+};
+
+typedef basic_sink<char> sink;
+typedef basic_sink<wchar_t> wsink;
+
+#if defined(CONV_HAS_CXX17)
+template <typename CharT, typename E,
+          typename = typename std::enable_if<
+              internal::has_enum_names<E>::value>::type>
+inline void conv_format(basic_sink<CharT>& out, const E& value) {
+    std::string_view name = internal::enum_name(value);
+
+    if (name.empty()) {
+        out << static_cast<typename std::underlying_type<E>::type>(value);
+    } else {
+        out.str().append(name.begin(), name.end());
+    }
+}
+#endif
+
+namespace internal {
+
+template <typename T, typename CharT>
+struct has_conv_format {
+    template <typename U>
+    static std::true_type test(
+        decltype(conv_format(std::declval<basic_sink<CharT>&>(),
+                             std::declval<const U&>()),
+                 void())*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+#if defined(CONV_HAS_CXX17)
+struct any_field {
+    template <typename T>
+    operator T() const;
+};
+
+template <typename T, typename... Fields>
+constexpr auto brace_constructible(int)
+    -> decltype(T{std::declval<Fields>()...}, true) {
+    return true;
+}
+
+template <typename T, typename... Fields>
+constexpr bool brace_constructible(...) {
+    return false;
+}
+
+template <typename T, typename... Fields>
+constexpr size_t field_count() {
+    if constexpr (sizeof...(Fields) <= 16 &&
+                  brace_constructible<T, Fields..., any_field>(0)) {
+        return field_count<T, Fields..., any_field>();
+    } else {
+        return sizeof...(Fields);
+    }
+}
+
+// Converts only to a base class of T. Bases come first in aggregate
+// initialization, so T{any_base<T>()} compiles only if T has a base.
+template <typename T>
+struct any_base {
+    template <typename U, typename = typename std::enable_if<
+                              std::is_base_of<U, T>::value &&
+                              !std::is_same<U, T>::value>::type>
+    operator U() const;
+};
+
+template <size_t I>
+struct field_probe {
+    typedef any_field type;
+};
+
+// A braced initializer per member is never elided into a C array, so this
+// holds only if field_count() counted each member once.
+template <typename T, size_t... Is>
+constexpr auto one_field_per_member(std::index_sequence<Is...>)
+    -> decltype(T{{std::declval<typename field_probe<Is>::type>()}...},
+                true) {
+    return true;
+}
+
+template <typename T>
+constexpr bool one_field_per_member(...) {
+    return false;
+}
+
+// Structured bindings see the direct members only. Brace initialization
+// also counts bases and every element of a C array, so tie_fields() can't
+// be used on such aggregates.
+template <typename T>
+constexpr bool bindable_fields() {
+    typedef std::make_index_sequence<field_count<T>()> fields;
+    return !brace_constructible<T, any_base<T> >(0) &&
+           one_field_per_member<T>(fields());
+}
+
+template <typename T>
+struct has_ostream_operator {
+    template <typename U>
+    static std::true_type test(
+        decltype(std::declval<std::ostream&>() << std::declval<const U&>(),
+                 void())*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+template <typename T, bool = std::is_class<T>::value&&
+                          std::is_aggregate<T>::value>
+struct is_reflectable : std::false_type {};
+
+template <typename T>
+struct is_reflectable<T, true>
+    : std::integral_constant<bool, !is_composite<T>::value &&
+                                       !has_ostream_operator<T>::value &&
+                                       (field_count<T>() > 0) &&
+                                       (field_count<T>() <= 16) &&
+                                       bindable_fields<T>()> {};
+
+template <size_t N, typename T>
+inline auto tie_fields(T& value) {
+    if constexpr (N == 1) {
+        auto& [a] = value;
+        return std::tie(a);
+    } else if constexpr (N == 2) {
+        auto& [a, b] = value;
+        return std::tie(a, b);
+    } else if constexpr (N == 3) {
+        auto& [a, b, c] = value;
+        return std::tie(a, b, c);
+    } else if constexpr (N == 4) {
+        auto& [a, b, c, d] = value;
+        return std::tie(a, b, c, d);
+    } else if constexpr (N == 5) {
+        auto& [a, b, c, d, e] = value;
+        return std::tie(a, b, c, d, e);
+    } else if constexpr (N == 6) {
+        auto& [a, b, c, d, e, f] = value;
+        return std::tie(a, b, c, d, e, f);
+    } else if constexpr (N == 7) {
+        auto& [a, b, c, d, e, f, g] = value;
+        return std::tie(a, b, c, d, e, f, g);
+    } else if constexpr (N == 8) {
+        auto& [a, b, c, d, e, f, g, h] = value;
+        return std::tie(a, b, c, d, e, f, g, h);
+    } else if constexpr (N == 9) {
+        auto& [a, b, c, d, e, f, g, h, i] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i);
+    } else if constexpr (N == 10) {
+        auto& [a, b, c, d, e, f, g, h, i, j] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j);
+    } else if constexpr (N == 11) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+    } else if constexpr (N == 12) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+    } else if constexpr (N == 13) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+    } else if constexpr (N == 14) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n);
+    } else if constexpr (N == 15) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o);
+    } else if constexpr (N == 16) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p);
+    }
+}
+
+template <typename T>
+inline auto tie_fields(T& value) {
+    return tie_fields<field_count<typename std::remove_const<T>::type>()>(
+        value);
+}
+
+template <typename CharT, typename Tuple, size_t... Is>
+inline void format_elements(std::basic_string<CharT>& out, const Tuple& t,
+                            std::index_sequence<Is...>) {
+    append_literal(out, "(");
+    ((append_literal(out, Is ? ", " : ""), format_value(out, std::get<Is>(t))),
+     ...);
+    append_literal(out, ")");
+}
+
+template <typename CharT, typename T>
+inline void format_object(std::basic_string<CharT>& out, const T& value,
+                          std::true_type) {
+    auto fields = tie_fields(value);
+    format_elements(
+        out, fields,
+        std::make_index_sequence<std::tuple_size<decltype(fields)>::value>());
+}
+
+template <typename CharT, typename... Ts>
+inline void format_value(std::basic_string<CharT>& out,
+                         const std::tuple<Ts...>& t) {
+    format_elements(out, t, std::index_sequence_for<Ts...>());
+}
+
+template <typename CharT, typename T, size_t N>
+inline void format_value(std::basic_string<CharT>& out,
+                         const std::array<T, N>& a) {
+    if constexpr (N > 0) {
+        append_literal(out, "[");
+
+        for (size_t i = 0; i < N; ++i) {
+            if (i) {
+                append_literal(out, ", ");
+            }
+
+            format_value(out, a[i]);
+        }
+
+        append_literal(out, "]");
+    }
+}
+
+template <typename CharT, typename T>
+inline void format_value(std::basic_string<CharT>& out,
+                         const std::optional<T>& o) {
+    if (o) {
+        format_value(out, *o);
+    }
+}
+
+template <typename CharT, typename... Ts>
+inline void format_value(std::basic_string<CharT>& out,
+                         const std::variant<Ts...>& v) {
+    if (!v.valueless_by_exception()) {
+        std::visit([&out](const auto& x) { format_value(out, x); }, v);
+    }
+}
+#else
+template <typename T>
+struct is_reflectable : std::false_type {};
+#endif
+
+template <typename CharT, typename T>
+inline void format_object(std::basic_string<CharT>& out, const T& value,
+                          std::false_type) {
+    format_scalar(out, value, is_number<T>());
+}
+
+template <typename CharT, typename T>
+inline void format_custom(std::basic_string<CharT>& out, const T& value,
+                          std::true_type) {
+    basic_sink<CharT> sink(out);
+    conv_format(sink, value);
+}
+
+template <typename CharT, typename T>
+inline void format_container(std::basic_string<CharT>& out, const T& value,
+                             std::integral_constant<int, no_container>) {
+    format_object(out, value, is_reflectable<T>());
+}
+
+template <typename CharT, typename C>
+inline void format_range(std::basic_string<CharT>& out, const C& c) {
+    typedef typename C::value_type value_t;
+    typedef typename C::const_iterator iterator;
+
+    if (c.empty()) {
+        return;
+    }
+
+    if (std::is_integral<value_t>::value) {
+        out.reserve(out.size() + element_size(c));
+    } else if (max_formatted_size<value_t>::value) {
+        out.reserve(out.size() + 2 +
+                    c.size() * (max_formatted_size<value_t>::value + 2));
+    }
+
+    append_literal(out, "[");
+
+    for (iterator iter = c.begin(); iter != c.end(); ++iter) {
+        if (iter != c.begin()) {
+            append_literal(out, ", ");
+        }
+
+        format_value(out, *iter);
+    }
+
+    append_literal(out, "]");
+}
+
+template <typename CharT, typename C>
+inline void format_container(std::basic_string<CharT>& out, const C& c,
+                             std::integral_constant<int, sequence_container>) {
+    format_range(out, c);
+}
+
+template <typename CharT, typename C>
+inline void format_container(std::basic_string<CharT>& out, const C& c,
+                             std::integral_constant<int, set_container>) {
+    format_range(out, c);
+}
+
+template <typename CharT, typename C>
+inline void format_container(std::basic_string<CharT>& out, const C& m,
+                             std::integral_constant<int, map_container>) {
+    typedef typename C::key_type key_t;
+    typedef typename C::mapped_type mapped_t;
+    typedef typename C::const_iterator iterator;
+
+    if (m.empty()) {
+        return;
+    }
+
+    if (max_formatted_size<key_t>::value && max_formatted_size<mapped_t>::value) {
+        out.reserve(out.size() + 2 +
+                    m.size() * (max_formatted_size<key_t>::value +
+                                max_formatted_size<mapped_t>::value + 4));
+    }
+
+    append_literal(out, "{");
+
+    for (iterator iter = m.begin(); iter != m.end(); ++iter) {
+        if (iter != m.begin()) {
+            append_literal(out, ", ");
+        }
+
+        format_value(out, iter->first);
+        append_literal(out, ": ");
+        format_value(out, iter->second);
+    }
+
+    append_literal(out, "}");
+}
+
+template <typename CharT, typename T>
+inline void format_custom(std::basic_string<CharT>& out, const T& value,
+                          std::false_type) {
+    format_container(out, value, container_tag<T>());
+}
+
+template <typename CharT, typename T>
+inline void format_value(std::basic_string<CharT>& out, const T& value) {
+    format_custom(
+        out, value,
+        std::integral_constant<bool, has_conv_format<T, CharT>::value>());
+}
+
+template <typename CharT>
+inline void format_value(std::basic_string<CharT>& out, bool value) {
+    out.push_back(value ? CharT('1') : CharT('0'));
+}
+
+inline void format_value(std::string& out, char value) {
+    out.push_back(value);
+}
+
+inline void format_value(std::string& out, signed char value) {
+    out.push_back(static_cast<char>(value));
+}
+
+inline void format_value(std::string& out, unsigned char value) {
+    out.push_back(static_cast<char>(value));
+}
+
+inline void format_value(std::wstring& out, char value) {
+    stream_value(out, value);
+}
+
+#if defined(CONV_HAS_INT128)
+template <typename CharT>
+inline void format_value(std::basic_string<CharT>& out, int128_t value) {
+    char buf[48];
+    char* last = buf + sizeof(buf);
+    bool negative = false;
+    char* first = write_integer(last, value, negative);
+
+    if (negative) {
+        *--first = '-';
+    }
+
+    out.append(first, last);
+}
+
+template <typename CharT>
+inline void format_value(std::basic_string<CharT>& out, uint128_t value) {
+    char buf[48];
+    char* last = buf + sizeof(buf);
+    out.append(write_unsigned(last, value), last);
+}
+#endif
+
+template <typename CharT, typename T>
+inline void format_value(std::basic_string<CharT>& out,
+                         const fixed_point<T>& f) {
+    char buf[48];
+    char* last = buf + sizeof(buf);
+    bool negative = false;
+    char* first = write_integer(last, f.value, negative);
+    size_t digits = static_cast<size_t>(last - first);
+
+    if (negative) {
+        out.push_back(CharT('-'));
+    }
+
+    if (f.scale == 0) {
+        out.append(first, last);
+    } else if (digits <= f.scale) {
+        append_literal(out, "0.");
+        out.append(f.scale - digits, CharT('0'));
+        out.append(first, last);
+    } else {
+        out.append(first, last - f.scale);
+        out.push_back(CharT('.'));
+        out.append(last - f.scale, last);
+    }
+}
+
+template <typename CharT>
+inline void format_value(std::basic_string<CharT>& out, const CharT* str) {
+    out.append(str);
+}
+
+template <typename CharT, typename Traits, typename Alloc>
+inline void format_value(std::basic_string<CharT>& out,
+                         const std::basic_string<CharT, Traits, Alloc>& str) {
+    out.append(str.data(), str.size());
+}
+
+template <typename CharT, typename T1, typename T2>
+inline void format_value(std::basic_string<CharT>& out,
+                         const std::pair<T1, T2>& p) {
+    append_literal(out, "(");
+    format_value(out, p.first);
+    append_literal(out, ", ");
+    format_value(out, p.second);
+    append_literal(out, ")");
+}
+
+template <typename CharT, typename T>
+inline void format_string(std::basic_string<CharT>& out, const T& value) {
+    format_value(out, value);
+}
+
+template <typename CharT>
+inline void format_string(std::basic_string<CharT>& out, bool value) {
+    append_literal(out, value ? "true" : "false");
+}
+
+template <typename CharT>
+inline void format_string(std::basic_string<CharT>& out, char value) {
+    append_integer(out, static_cast<int>(value));
+}
+
+template <typename CharT>
+inline void format_string(std::basic_string<CharT>& out, signed char value) {
+    append_integer(out, static_cast<int>(value));
+}
+
+template <typename CharT>
+inline void format_string(std::basic_string<CharT>& out, unsigned char value) {
+    append_integer(out, static_cast<int>(value));
+}
+
+inline void format_string(std::string& out, const wchar_t* wstr) {
+    CONV_STAT_SCOPE(stat_transcode);
+    std::vector<char> mbs(std::wcslen(wstr) * MB_CUR_MAX + 1);
+    std::wcstombs(mbs.data(), wstr, mbs.size());
+    out.append(mbs.data());
+}
+
+inline void format_string(std::string& out, const std::wstring& wstr) {
+    format_string(out, wstr.c_str());
+}
+
+inline void format_string(std::wstring& out, const char* str) {
+    CONV_STAT_SCOPE(stat_transcode);
+    std::vector<wchar_t> wcs(std::strlen(str) + 1);
+    std::mbstowcs(wcs.data(), str, wcs.size());
+    out.append(wcs.data());
+}
+
+inline void format_string(std::wstring& out, const std::string& str) {
+    format_string(out, str.c_str());
+}
+
+}  // namespace internal
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+class to {
+   public:
+    template <typename U>
+    explicit to(const U& value) {
+        value_ = static_cast<T>(value);
+    }
+
+    explicit to(const char* str) : value_() {
+        from_string(str, str + std::char_traits<char>::length(str));
+    }
+
+    explicit to(const std::string& str) : value_() {
+        from_string(str.data(), str.data() + str.size());
+    }
+
+    explicit to(const wchar_t* str) : value_() {
+        from_string(str, str + std::char_traits<wchar_t>::length(str));
+    }
+
+    explicit to(const std::wstring& str) : value_() {
+        from_string(str.data(), str.data() + str.size());
+    }
+
+    to(const std::string& str, const std::locale& loc) : value_() {
+        from_string(str.data(), str.data() + str.size(), loc);
+    }
+
+    to(const std::wstring& str, const std::locale& loc) : value_() {
+        from_string(str.data(), str.data() + str.size(), loc);
+    }
+
+    operator T() const { return value_; }
+
+   private:
+    template <typename CharT>
+    void from_string(const CharT* first, const CharT* last) {
+        CONV_STAT_SCOPE(stat_read);
+        CONV_LATENCY_SCOPE(std::basic_string<CharT>, T);
+        internal::trim(first, last);
+        assert(first != last);
+        assert(std::find_if(first, last, internal::is_space<CharT>) == last);
+
+        internal::read_value(first, last, value_);
+    }
+
+    template <typename CharT>
+    void from_string(const CharT* first, const CharT* last,
+                     const std::locale& loc) {
+        CONV_STAT_SCOPE(stat_read);
+        CONV_LATENCY_SCOPE(std::basic_string<CharT>, T);
+        internal::trim(first, last);
+        assert(first != last);
+
+        internal::read_stream(first, last, value_, loc);
+    }
+
+    T value_;
+};
+
+//-----------------------------------------------------------------------------
+
+template <>
+class to<char> {
+   public:
+    template <typename U>
+    explicit to(const U& value) {
+        value_ = static_cast<char>(value);
+    }
+
+    explicit to(const char* str) { value_ = static_cast<char>(to<int>(str)); }
+
+    explicit to(const std::string& str) {
+        value_ = static_cast<char>(to<int>(str));
+    }
+
+    explicit to(const wchar_t* wstr) {
+        value_ = static_cast<char>(to<int>(wstr));
+    }
+
+    explicit to(const std::wstring& wstr) {
+        value_ = static_cast<char>(to<int>(wstr));
+    }
+
+    operator char() const { return value_; }
+
+   private:
+    char value_;
+};
+
+//-----------------------------------------------------------------------------
+
+template <>
+class to<signed char> {
+   public:
+    template <typename U>
+    explicit to(const U& value) {
+        value_ = static_cast<signed char>(value);
+    }
+
+    explicit to(const char* str) {
+        value_ = static_cast<signed char>(to<int>(str));
+    }
+
+    explicit to(const std::string& str) {
+        value_ = static_cast<signed char>(to<int>(str));
+    }
+
+    explicit to(const wchar_t* wstr) {
+        value_ = static_cast<signed char>(to<int>(wstr));
+    }
+
+    explicit to(const std::wstring& wstr) {
+        value_ = static_cast<signed char>(to<int>(wstr));
+    }
+
+    operator signed char() const { return value_; }
+
+   private:
+    signed char value_;
+};
+
+//-----------------------------------------------------------------------------
+
+template <>
+class to<unsigned char> {
+   public:
+    template <typename U>
+    explicit to(const U& value) {
+        value_ = static_cast<unsigned char>(value);
+    }
+
+    explicit to(const char* str) {
+        value_ = static_cast<unsigned char>(to<int>(str));
+    }
+
+    explicit to(const std::string& str) {
+        value_ = static_cast<unsigned char>(to<int>(str));
+    }
+
+    explicit to(const wchar_t* str) {
+        value_ = static_cast<unsigned char>(to<int>(str));
+    }
+
+    explicit to(const std::wstring& wstr) {
+        value_ = static_cast<unsigned char>(to<int>(wstr));
+    }
+
+    operator unsigned char() const { return value_; }
+
+   private:
+    unsigned char value_;
+};
+
+//-----------------------------------------------------------------------------
+
+template <>
+class to<bool> {
+   public:
+    template <typename T>
+    explicit to(const T& value) {
+        value_ = static_cast<bool>(value);
+    }
+
+    explicit to(const char* str, unsigned vocabulary = bool_any) {
+        from_string(str, str + std::char_traits<char>::length(str), vocabulary);
+    }
+
+    explicit to(const std::string& str, unsigned vocabulary = bool_any) {
+        from_string(str.data(), str.data() + str.size(), vocabulary);
+    }
+
+    explicit to(const wchar_t* wstr, unsigned vocabulary = bool_any) {
+        from_string(wstr, wstr + std::char_traits<wchar_t>::length(wstr),
+                    vocabulary);
+    }
+
+    explicit to(const std::wstring& wstr, unsigned vocabulary = bool_any) {
+        from_string(wstr.data(), wstr.data() + wstr.size(), vocabulary);
+    }
+
+    operator bool() const { return value_; }
+
+   private:
+    template <typename CharT>
+    void from_string(const CharT* first, const CharT* last,
+                     unsigned vocabulary) {
+        CONV_STAT_SCOPE(stat_read);
+        CONV_LATENCY_SCOPE(std::basic_string<CharT>, bool);
+        internal::trim(first, last);
+        internal::parse_bool(first, last, vocabulary, value_);
+    }
+
+    bool value_;
+};
+
+//-----------------------------------------------------------------------------
+
+template <>
+class to<std::string> : public std::string {
+   public:
+    template <typename U>
+    explicit to(const U& value) {
+        CONV_STAT_SCOPE(stat_format);
+        CONV_LATENCY_SCOPE(U, std::string);
+        internal::format_string(static_cast<std::string&>(*this), value);
+    }
+
+    template <typename U>
+    to(const U& value, const std::locale& loc) {
+        CONV_STAT_SCOPE(stat_format);
+        CONV_LATENCY_SCOPE(U, std::string);
+        internal::stream_value(static_cast<std::string&>(*this), value, loc);
+    }
+
+    explicit to(const char* str) : std::string(str) {}
+    explicit to(const std::string& str) : std::string(str) {}
+};
+
+//-----------------------------------------------------------------------------
+
+template <>
+class to<std::wstring> : public std::wstring {
+   public:
+    template <typename U>
+    explicit to(const U& value) {
+        CONV_STAT_SCOPE(stat_format);
+        CONV_LATENCY_SCOPE(U, std::wstring);
+        internal::format_string(static_cast<std::wstring&>(*this), value);
+    }
+
+    template <typename U>
+    to(const U& value, const std::locale& loc) {
+        CONV_STAT_SCOPE(stat_format);
+        CONV_LATENCY_SCOPE(U, std::wstring);
+        internal::stream_value(static_cast<std::wstring&>(*this), value, loc);
+    }
+
+    explicit to(const wchar_t* wstr) : std::wstring(wstr) {}
+    explicit to(const std::wstring& wstr) : std::wstring(wstr) {}
+};
+
+//-----------------------------------------------------------------------------
+
+#if defined(CONV_HAS_CXX17)
+template <>
+class to<std::string_view> : public std::string_view {
+   public:
+    template <typename E, typename = typename std::enable_if<
+                              internal::has_enum_names<E>::value>::type>
+    explicit to(const E& value) : std::string_view(internal::enum_name(value)) {}
+};
+
+//-----------------------------------------------------------------------------
+#endif
+
+template <typename CharT, typename Traits, typename Alloc>
+class to<std::basic_string<CharT, Traits, Alloc> >
+    : public std::basic_string<CharT, Traits, Alloc> {
+   public:
+    typedef std::basic_string<CharT, Traits, Alloc> string_t;
+
+    template <typename U>
+    explicit to(const U& value, const Alloc& alloc = Alloc())
+          : string_t(alloc) {
+        CONV_STAT_SCOPE(stat_format);
+        CONV_LATENCY_SCOPE(U, string_t);
+        internal::scratch_string<CharT> scratch;
+        internal::format_string(scratch.str(), value);
+        string_t::assign(scratch.str().data(), scratch.str().size());
+    }
+
+    explicit to(const CharT* str, const Alloc& alloc = Alloc())
+          : string_t(str, alloc) {}
+};
+
+//-----------------------------------------------------------------------------
+
+template <typename T1, typename T2>
+class to<std::pair<T1, T2> > : public std::pair<T1, T2> {
+   public:
+    template <typename U1, typename U2>
+    explicit to(const std::pair<U1, U2>& p) {
+        std::pair<T1, T2>::first = to<T1>(p.first);
+        std::pair<T1, T2>::second = to<T2>(p.second);
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+namespace internal {
+
+template <typename C>
+inline auto allocator_of(const C& c, int) -> decltype(c.get_allocator()) {
+    return c.get_allocator();
+}
+
+template <typename C>
+inline std::allocator<typename C::value_type> allocator_of(const C&, long) {
+    return std::allocator<typename C::value_type>();
+}
+
+template <typename T, typename Alloc>
+struct is_allocator_constructible
+    : std::integral_constant<bool, std::uses_allocator<T, Alloc>::value &&
+                                       std::is_constructible<
+                                           T, const Alloc&>::value> {};
+
+template <typename T, typename Alloc>
+inline T make_element(const Alloc& alloc, std::true_type) {
+    return T(alloc);
+}
+
+template <typename T, typename Alloc>
+inline T make_element(const Alloc&, std::false_type) {
+    return T();
+}
+
+template <typename T, typename Alloc>
+inline T make_element(const Alloc& alloc) {
+    return make_element<T>(alloc, is_allocator_constructible<T, Alloc>());
+}
+
+template <typename T, typename V, typename Alloc>
+inline to<T> convert_to(const V& value, const Alloc& alloc, std::true_type) {
+    return to<T>(value, alloc);
+}
+
+template <typename T, typename V, typename Alloc>
+inline to<T> convert_to(const V& value, const Alloc&, std::false_type) {
+    return to<T>(value);
+}
+
+template <typename T, typename V, typename Alloc>
+inline to<T> convert_to(const V& value, const Alloc& alloc) {
+    return convert_to<T>(
+        value, alloc,
+        std::integral_constant<bool, std::uses_allocator<T, Alloc>::value &&
+                                         std::is_constructible<
+                                             to<T>, const V&,
+                                             const Alloc&>::value>());
+}
+
+enum insert_kind { back_insert, hint_insert, hash_insert, bulk_insert };
+
+template <typename C, typename Traits = container_traits<C> >
+struct insert_strategy
+    : std::integral_constant<
+          int, Traits::flat ? bulk_insert
+                            : Traits::kind == set_container ||
+                                      Traits::kind == map_container
+                                  ? (Traits::sorted ? hint_insert : hash_insert)
+                                  : back_insert> {};
+
+template <typename C, int Strategy = insert_strategy<C>::value>
+class container_inserter {
+   public:
+    explicit container_inserter(C& c) : c_(c) {}
+
+    void reserve(size_t n) {
+        reserve(n, std::integral_constant<bool,
+                                          container_traits<C>::reservable>());
+    }
+
+    template <typename V>
+    void insert(V&& value) {
+        insert(std::forward<V>(value), std::integral_constant<int, Strategy>());
+    }
+
+    void flush() {}
+
+   private:
+    void reserve(size_t n, std::true_type) { c_.reserve(c_.size() + n); }
+    void reserve(size_t, std::false_type) {}
+
+    template <typename V>
+    void insert(V&& value, std::integral_constant<int, back_insert>) {
+        c_.push_back(std::forward<V>(value));
+    }
+
+    template <typename V>
+    void insert(V&& value, std::integral_constant<int, hint_insert>) {
+        insert_sorted(std::forward<V>(value), container_tag<C>());
+    }
+
+    template <typename V>
+    void insert(V&& value, std::integral_constant<int, hash_insert>) {
+        insert_hashed(std::forward<V>(value), container_tag<C>());
+    }
+
+    template <typename V>
+    void insert_sorted(V&& value, std::integral_constant<int, set_container>) {
+        c_.emplace_hint(c_.end(), std::forward<V>(value));
+    }
+
+    // A map keeps the last of several entries for one key, so that a
+    // collision between converted keys resolves as operator[] would.
+    template <typename V>
+    void insert_sorted(V&& value, std::integral_constant<int, map_container>) {
+#if defined(CONV_HAS_CXX17)
+        c_.insert_or_assign(c_.end(), std::move(value.first),
+                            std::move(value.second));
+#else
+        typename C::iterator hint = c_.end();
+
+        typename C::key_compare less = c_.key_comp();
+
+        if (!c_.empty() && !less(std::prev(hint)->first, value.first)) {
+            hint = c_.lower_bound(value.first);
+
+            if (hint != c_.end() && !less(value.first, hint->first)) {
+                hint->second = std::move(value.second);
+                return;
+            }
+        }
+
+        c_.emplace_hint(hint, std::forward<V>(value));
+#endif
+    }
+
+    template <typename V>
+    void insert_hashed(V&& value, std::integral_constant<int, set_container>) {
+        c_.emplace(std::forward<V>(value));
+    }
+
+    template <typename V>
+    void insert_hashed(V&& value, std::integral_constant<int, map_container>) {
+#if defined(CONV_HAS_CXX17)
+        c_.insert_or_assign(std::move(value.first), std::move(value.second));
+#else
+        typename C::iterator iter = c_.find(value.first);
+
+        if (iter != c_.end()) {
+            iter->second = std::move(value.second);
+            return;
+        }
+
+        c_.emplace(std::forward<V>(value));
+#endif
+    }
+
+    C& c_;
+};
+
+template <typename C>
+struct key_less {
+    explicit key_less(const C& c) : less(c.key_comp()) {}
+
+    bool operator()(const typename C::value_type& a,
+                    const typename C::value_type& b) const {
+        return less(a.first, b.first);
+    }
+
+    typename C::key_compare less;
+};
+
+template <typename C>
+class container_inserter<C, bulk_insert> {
+   public:
+    explicit container_inserter(C& c) : c_(c) {}
+
+    void reserve(size_t n) { buffer_.reserve(buffer_.size() + n); }
+
+    template <typename V>
+    void insert(V&& value) {
+        buffer_.push_back(std::forward<V>(value));
+    }
+
+    void flush() {
+        keep_last(container_tag<C>());
+        c_.insert(std::make_move_iterator(buffer_.begin()),
+                  std::make_move_iterator(buffer_.end()));
+        buffer_.clear();
+    }
+
+   private:
+    typedef typename std::vector<typename C::value_type>::iterator iterator;
+
+    void keep_last(std::integral_constant<int, set_container>) {}
+
+    // The range insert keeps an unspecified one of several entries for a
+    // key, so drop all but the last before handing the buffer over.
+    void keep_last(std::integral_constant<int, map_container>) {
+        key_less<C> less(c_);
+        std::stable_sort(buffer_.begin(), buffer_.end(), less);
+
+        iterator out = buffer_.begin();
+
+        for (iterator iter = buffer_.begin(); iter != buffer_.end(); ++iter) {
+            iterator next = std::next(iter);
+
+            if (next != buffer_.end() && !less(*iter, *next)) {
+                continue;
+            }
+
+            if (out != iter) {
+                *out = std::move(*iter);
+            }
+
+            ++out;
+        }
+
+        buffer_.erase(out, buffer_.end());
+    }
+
+    C& c_;
+    std::vector<typename C::value_type> buffer_;
+};
+
+template <typename C>
+class insert_output {
+   public:
+    explicit insert_output(container_inserter<C>& inserter)
+          : inserter_(&inserter) {}
+
+    insert_output& operator*() { return *this; }
+    insert_output& operator++() { return *this; }
+    insert_output operator++(int) { return *this; }
+
+    template <typename V>
+    insert_output& operator=(V&& value) {
+        inserter_->insert(std::forward<V>(value));
+        return *this;
+    }
+
+   private:
+    container_inserter<C>* inserter_;
+};
+
+template <typename C>
+class converted_container : public C {
+   protected:
+    template <typename U>
+    explicit converted_container(const U& source) {
+        convert(source);
+    }
+
+    template <typename U, typename Alloc>
+    converted_container(const U& source, const Alloc& alloc) : C(alloc) {
+        convert(source);
+    }
+
+   private:
+    template <typename U>
+    void convert(const U& source) {
+        typedef typename U::const_iterator iterator;
+
+        CONV_STAT_SCOPE(stat_convert);
+        CONV_LATENCY_SCOPE(U, C);
+
+        container_inserter<C> inserter(*this);
+        inserter.reserve(source.size());
+
+        for (iterator iter = source.begin(); iter != source.end(); ++iter) {
+            add(inserter, *iter, container_tag<C>());
+        }
+
+        inserter.flush();
+    }
+
+    template <typename V, int Kind>
+    void add(container_inserter<C>& inserter, const V& value,
+             std::integral_constant<int, Kind>) {
+        typedef typename C::value_type value_t;
+
+        inserter.insert(convert_to<value_t>(value, allocator_of(*this, 0)));
+    }
+
+    template <typename V>
+    void add(container_inserter<C>& inserter, const V& value,
+             std::integral_constant<int, map_container>) {
+        typedef typename C::key_type key_t;
+        typedef typename C::mapped_type mapped_t;
+
+        inserter.insert(std::pair<key_t, mapped_t>(
+            convert_to<key_t>(value.first, allocator_of(*this, 0)),
+            convert_to<mapped_t>(value.second, allocator_of(*this, 0))));
+    }
+};
+
+}  // namespace internal
+
+//-----------------------------------------------------------------------------
+
+template <typename T, typename Alloc>
+class to<std::vector<T, Alloc> >
+    : public internal::converted_container<std::vector<T, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<std::vector<T, Alloc> >(source,
+                                                                  alloc) {}
+};
+
+template <typename T, typename Alloc>
+class to<std::deque<T, Alloc> >
+    : public internal::converted_container<std::deque<T, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<std::deque<T, Alloc> >(source,
+                                                                 alloc) {}
+};
+
+template <typename T, typename Alloc>
+class to<std::list<T, Alloc> >
+    : public internal::converted_container<std::list<T, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<std::list<T, Alloc> >(source,
+                                                                alloc) {}
+};
+
+template <typename T, typename Compare, typename Alloc>
+class to<std::set<T, Compare, Alloc> >
+    : public internal::converted_container<std::set<T, Compare, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<std::set<T, Compare, Alloc> >(
+                source, alloc) {}
+};
+
+template <typename T, typename Hash, typename Pred, typename Alloc>
+class to<std::unordered_set<T, Hash, Pred, Alloc> >
+    : public internal::converted_container<
+          std::unordered_set<T, Hash, Pred, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<
+                std::unordered_set<T, Hash, Pred, Alloc> >(source, alloc) {}
+};
+
+//-----------------------------------------------------------------------------
+
+template <typename K, typename V, typename Compare, typename Alloc>
+class to<std::map<K, V, Compare, Alloc> >
+    : public internal::converted_container<std::map<K, V, Compare, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<std::map<K, V, Compare, Alloc> >(
+                source, alloc) {}
+};
+
+template <typename K, typename V, typename Hash, typename Pred, typename Alloc>
+class to<std::unordered_map<K, V, Hash, Pred, Alloc> >
+    : public internal::converted_container<
+          std::unordered_map<K, V, Hash, Pred, Alloc> > {
+   public:
+    template <typename U>
+    explicit to(const U& source, const Alloc& alloc = Alloc())
+          : internal::converted_container<
+                std::unordered_map<K, V, Hash, Pred, Alloc> >(source, alloc) {
+    }
+};
+
+#if defined(CONV_HAS_FLAT_MAP)
+template <typename K, typename V>
+class to<std::flat_map<K, V> >
+    : public internal::converted_container<std::flat_map<K, V> > {
+   public:
+    template <typename U>
+    explicit to(const U& source)
+          : internal::converted_container<std::flat_map<K, V> >(source) {}
+};
+#endif
+
+#if defined(CONV_HAS_FLAT_SET)
+template <typename T>
+class to<std::flat_set<T> >
+    : public internal::converted_container<std::flat_set<T> > {
+   public:
+    template <typename U>
+    explicit to(const U& source)
+          : internal::converted_container<std::flat_set<T> >(source) {}
+};
+#endif
+
+#if defined(CONV_HAS_CXX17)
+
+//-----------------------------------------------------------------------------
+
+template <typename... Ts>
+class to<std::tuple<Ts...> > : public std::tuple<Ts...> {
+   public:
+    template <typename... Us>
+    explicit to(const std::tuple<Us...>& t)
+          : to(t, std::index_sequence_for<Us...>()) {}
+
+   private:
+    template <typename Tuple, size_t... Is>
+    to(const Tuple& t, std::index_sequence<Is...>)
+          : std::tuple<Ts...>(static_cast<Ts>(to<Ts>(std::get<Is>(t)))...) {}
+};
+
+//-----------------------------------------------------------------------------
+
+template <typename T, size_t N>
+class to<std::array<T, N> > : public std::array<T, N> {
+   public:
+    template <typename U>
+    explicit to(const std::array<U, N>& a) : std::array<T, N>() {
+        for (size_t i = 0; i < N; ++i) {
+            (*this)[i] = to<T>(a[i]);
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+class to<std::optional<T> > : public std::optional<T> {
+   public:
+    template <typename U>
+    explicit to(const std::optional<U>& o) {
+        if (o) {
+            std::optional<T>::emplace(to<T>(*o));
+        }
+    }
+};
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+class string_column {
+   public:
+    string_column() : offsets_(1, 0) {}
+
+    size_t size() const { return offsets_.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    const char* data() const { return chars_.data(); }
+    const std::string& chars() const { return chars_; }
+    const std::vector<size_t>& offsets() const { return offsets_; }
+
+    std::string str(size_t i) const {
+        return chars_.substr(offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+#if defined(CONV_HAS_CXX17)
+    std::string_view operator[](size_t i) const {
+        return std::string_view(chars_.data() + offsets_[i],
+                                offsets_[i + 1] - offsets_[i]);
+    }
+#endif
+
+   protected:
+    std::string chars_;
+    std::vector<size_t> offsets_;
+};
+
+template <>
+class to<string_column> : public string_column {
+   public:
+    template <typename T, typename Alloc>
+    explicit to(const std::vector<T, Alloc>& v) {
+        from_vector(v, std::integral_constant<bool, is_integer<T>::value>());
+    }
+
+   private:
+    template <typename T>
+    struct is_integer
+        : std::integral_constant<bool, std::is_integral<T>::value &&
+                                           !std::is_same<T, bool>::value> {};
+
+    template <typename T, typename Alloc>
+    void from_vector(const std::vector<T, Alloc>& v, std::true_type) {
+        typedef typename std::make_unsigned<T>::type unsigned_t;
+
+        offsets_.resize(v.size() + 1);
+
+        for (size_t i = 0; i < v.size(); ++i) {
+            offsets_[i + 1] = internal::integer_size(v[i]);
+        }
+
+        for (size_t i = 0; i < v.size(); ++i) {
+            offsets_[i + 1] += offsets_[i];
+        }
+
+        chars_.resize(offsets_.back());
+        char* arena = &chars_[0];
+
+        for (size_t i = 0; i < v.size(); ++i) {
+            unsigned_t u = static_cast<unsigned_t>(v[i]);
+
+            if (std::is_signed<T>::value && v[i] < T(0)) {
+                arena[offsets_[i]] = '-';
+                u = unsigned_t(0) - u;
+            }
+
+            internal::write_unsigned(arena + offsets_[i + 1], u);
+        }
+    }
+
+    template <typename T, typename Alloc>
+    void from_vector(const std::vector<T, Alloc>& v, std::false_type) {
+        offsets_.reserve(v.size() + 1);
+
+        for (size_t i = 0; i < v.size(); ++i) {
+            internal::format_string(chars_, v[i]);
+            offsets_.push_back(chars_.size());
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+inline size_t formatted_size(const T& value) {
+    return internal::element_size(value);
+}
+
+inline size_t formatted_size(bool value) { return value ? 4 : 5; }
+
+inline size_t formatted_size(char value) {
+    return internal::integer_size(static_cast<int>(value));
+}
+
+inline size_t formatted_size(signed char value) {
+    return internal::integer_size(static_cast<int>(value));
+}
+
+inline size_t formatted_size(unsigned char value) {
+    return internal::integer_size(static_cast<int>(value));
+}
+
+inline size_t formatted_size(const wchar_t* wstr) {
+    size_t size = std::wcstombs(NULL, wstr, 0);
+    return size == static_cast<size_t>(-1) ? 0 : size;
+}
+
+inline size_t formatted_size(const std::wstring& wstr) {
+    return formatted_size(wstr.c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+class parse_options {
+   public:
+    parse_options()
+          : lbracket_("["),
+            rbracket_("]"),
+            comma_(","),
+            colon_(":"),
+            quote_("\""),
+            escape_(""),
+            booleans_(bool_any) {}
+
+    parse_options& lbracket(const std::string& s) {
+        lbracket_ = s;
+        return *this;
+    }
+
+    const std::string& lbracket() const { return lbracket_; }
+
+    parse_options& rbracket(const std::string& s) {
+        rbracket_ = s;
+        return *this;
+    }
+
+    const std::string& rbracket() const { return rbracket_; }
+
+    parse_options& comma(const std::string& s) {
+        comma_ = s;
+        return *this;
+    }
+
+    const std::string& comma() const { return comma_; }
+
+    parse_options& colon(const std::string& s) {
+        colon_ = s;
+        return *this;
+    }
+
+    const std::string& colon() const { return colon_; }
+
+    parse_options& quote(const std::string& s) {
+        quote_ = s;
+        return *this;
+    }
+
+    const std::string& quote() const { return quote_; }
+
+    parse_options& escape(const std::string& s) {
+        escape_ = s;
+        return *this;
+    }
+
+    const std::string& escape() const { return escape_; }
+
+    parse_options& booleans(unsigned vocabulary) {
+        booleans_ = vocabulary;
+        return *this;
+    }
+
+    unsigned booleans() const { return booleans_; }
+
+   private:
+    std::string lbracket_;
+    std::string rbracket_;
+    std::string comma_;
+    std::string colon_;
+    std::string quote_;
+    std::string escape_;
+    unsigned booleans_;
+};
+
+inline parse_options lbracket(const std::string& s) {
+    return parse_options().lbracket(s);
+}
+
+inline parse_options rbracket(const std::string& s) {
+    return parse_options().rbracket(s);
+}
+
+inline parse_options comma(const std::string& s) {
+    return parse_options().comma(s);
+}
+
+inline parse_options colon(const std::string& s) {
+    return parse_options().colon(s);
+}
+
+inline parse_options quote(const std::string& s) {
+    return parse_options().quote(s);
+}
+
+inline parse_options escape(const std::string& s) {
+    return parse_options().escape(s);
+}
+
+inline parse_options booleans(unsigned vocabulary) {
+    return parse_options().booleans(vocabulary);
+}
+
+namespace internal {
+
+typedef unsigned long long block_mask_t;
+
+inline unsigned popcount64(block_mask_t x) {
+    return popcount(static_cast<unsigned>(x)) +
+           popcount(static_cast<unsigned>(x >> 32));
+}
+
+inline unsigned count_trailing_zeros64(block_mask_t x) {
+    unsigned low = static_cast<unsigned>(x);
+    return low ? count_trailing_zeros(low)
+               : 32 + count_trailing_zeros(static_cast<unsigned>(x >> 32));
+}
+
+inline block_mask_t prefix_xor(block_mask_t x) {
+#if defined(CONV_HAS_PCLMUL)
+    __m128i bits = _mm_set_epi64x(0, static_cast<long long>(x));
+    __m128i ones = _mm_set1_epi8(-1);
+    return static_cast<block_mask_t>(
+        _mm_cvtsi128_si64(_mm_clmulepi64_si128(bits, ones, 0)));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+inline block_mask_t block_mask(const char* block, const std::string& set) {
+    block_mask_t mask = 0;
+
+#if defined(CONV_HAS_SSE2)
+    __m128i needles[4];
+
+    if (size_t size = load_needles(needles, set)) {
+        for (int i = 0; i < 4; ++i) {
+            mask |= static_cast<block_mask_t>(
+                        match_any(block + 16 * i, needles, size))
+                    << (16 * i);
+        }
+
+        return mask;
+    }
+#endif
+
+    for (int i = 0; i < 64; ++i) {
+        mask |= static_cast<block_mask_t>(is_any_of(block[i], set)) << i;
+    }
+
+    return mask;
+}
+
+// Numbers and booleans can't contain a separator, a quote or an escape, so
+// fields of those types are split with the plain search even when quoting
+// is on; unquote() still strips quotes around each field.
+template <typename T>
+struct is_quotable
+    : std::integral_constant<bool, !std::is_arithmetic<T>::value> {};
+
+template <typename... Ts>
+struct any_quotable : std::false_type {};
+
+template <typename T, typename... Ts>
+struct any_quotable<T, Ts...>
+    : std::integral_constant<bool, is_quotable<T>::value ||
+                                       any_quotable<Ts...>::value> {};
+
+class field_scanner {
+   public:
+    field_scanner(const char* first, const char* last, const std::string& set,
+                  const parse_options& opt, bool quotable)
+          : next_(first),
+            last_(last),
+            block_(first),
+            mask_(0),
+            in_quote_(0),
+            escaped_(0),
+            set_(set),
+            quote_(quotable ? opt.quote().substr(0, 1) : std::string()),
+            escape_(quotable ? opt.escape().substr(0, 1) : std::string()) {}
+
+    const char* next() {
+        if (quote_.empty() && escape_.empty()) {
+            const char* pos = find_any_of(next_, last_, set_);
+            next_ = pos == last_ ? last_ : pos + 1;
+            return pos;
+        }
+
+        while (!mask_) {
+            if (!load()) {
+                return last_;
+            }
+        }
+
+        const char* pos = block_ + count_trailing_zeros64(mask_);
+        mask_ &= mask_ - 1;
+        return pos;
+    }
+
+    size_t count() {
+        if (quote_.empty() && escape_.empty()) {
+            return count_any_of(next_, last_, set_);
+        }
+
+        size_t n = 0;
+
+        do {
+            n += popcount64(mask_);
+            mask_ = 0;
+        } while (load());
+
+        return n;
+    }
+
+   private:
+    bool load() {
+        if (next_ == last_) {
+            return false;
+        }
+
+        size_t size = static_cast<size_t>(last_ - next_);
+        block_mask_t valid = ~block_mask_t(0);
+        const char* block = next_;
+        char buf[64];
+
+        if (size < 64) {
+            std::memcpy(buf, next_, size);
+            std::memset(buf + size, 0, 64 - size);
+            block = buf;
+            valid = (block_mask_t(1) << size) - 1;
+        } else {
+            size = 64;
+        }
+
+        block_ = next_;
+        next_ += size;
+
+        block_mask_t escaped = 0;
+
+        if (!escape_.empty()) {
+            const block_mask_t even_bits = 0x5555555555555555ULL;
+
+            block_mask_t backslash = block_mask(block, escape_) & ~escaped_;
+            block_mask_t follows = (backslash << 1) | escaped_;
+            block_mask_t odd_starts = backslash & ~even_bits & ~follows;
+            block_mask_t even_runs = odd_starts + backslash;
+
+            escaped_ = even_runs < backslash ? 1 : 0;
+            escaped = (even_bits ^ (even_runs << 1)) & follows;
+        }
+
+        block_mask_t quotes =
+            quote_.empty() ? 0 : block_mask(block, quote_) & ~escaped;
+        block_mask_t inside = prefix_xor(quotes) ^ in_quote_;
+
+        in_quote_ = (inside >> 63) ? ~block_mask_t(0) : 0;
+        mask_ = block_mask(block, set_) & ~inside & ~escaped & valid;
+
+        return true;
+    }
+
+    const char* next_;
+    const char* last_;
+    const char* block_;
+    block_mask_t mask_;
+    block_mask_t in_quote_;
+    block_mask_t escaped_;
+    const std::string& set_;
+    std::string quote_;
+    std::string escape_;
+};
+
+inline void unquote(const char*& first, const char*& last,
+                    const parse_options& opt, std::string& scratch) {
+    const char quote = opt.quote().empty() ? '\0' : opt.quote()[0];
+    const char escape = opt.escape().empty() ? '\0' : opt.escape()[0];
+    bool quoted = quote && first != last && *first == quote;
+
+    if (quoted) {
+        ++first;
+
+        if (first != last && *(last - 1) == quote) {
+            // The closing quote is escaped only by an odd run of escapes.
+            const char* run = last - 1;
+
+            while (escape && run != first && *(run - 1) == escape) {
+                --run;
+            }
+
+            if ((last - 1 - run) % 2 == 0) {
+                --last;
+            }
+        }
+    }
+
+    const char* p = first;
+
+    while (p != last && !(quoted && *p == quote) && !(escape && *p == escape)) {
+        ++p;
+    }
+
+    if (p == last) {
+        return;
+    }
+
+    scratch.assign(first, p);
+
+    for (; p != last; ++p) {
+        if ((escape && *p == escape) ||
+            (quoted && *p == quote && p + 1 != last && p[1] == quote)) {
+            if (++p == last) {
+                break;
+            }
+        }
+
+        scratch.push_back(*p);
+    }
+
+    first = scratch.data();
+    last = first + scratch.size();
+}
+
+inline void strip_brackets(const char*& first, const char*& last,
+                           const parse_options& opt) {
+    trim(first, last);
+    assert(first != last);
+
+    if (!opt.lbracket().empty()) {
+        assert(*first == opt.lbracket()[0]);
+        ++first;
+        trim(first, last);
+    }
+
+    if (!opt.rbracket().empty()) {
+        assert(first != last && *(last - 1) == opt.rbracket()[0]);
+        --last;
+        trim(first, last);
+    }
+
+    assert(first != last);
+}
+
+template <typename T>
+inline bool read_field(const char* first, const char* last, T& value,
+                       std::true_type) {
+    return read_value(first, last, value);
+}
+
+template <typename T>
+inline bool read_custom(const char* first, const char* last, T& value,
+                        std::true_type) {
+    return read_value(first, last, value);
+}
+
+template <typename T>
+inline bool read_custom(const char* first, const char* last, T& value,
+                        std::false_type) {
+    value = to<T>(std::string(first, last));
+    return true;
+}
+
+template <typename T>
+inline bool read_field(const char* first, const char* last, T& value,
+                       std::false_type) {
+    return read_custom(first, last, value,
+                       std::integral_constant<bool, has_conv_parse<T>::value>());
+}
+
+template <typename T>
+inline bool read_field(const char* first, const char* last, T& value) {
+    return read_field(first, last, value, is_number<T>());
+}
+
+template <typename Traits, typename Alloc>
+inline bool read_field(const char* first, const char* last,
+                       std::basic_string<char, Traits, Alloc>& value) {
+    value.assign(first, last);
+    return true;
+}
+
+template <typename T>
+inline bool read_field(const char* first, const char* last, T& value,
+                       const parse_options&) {
+    return read_field(first, last, value);
+}
+
+inline bool read_field(const char* first, const char* last, bool& value,
+                       const parse_options& opt) {
+    return parse_bool(first, last, opt.booleans(), value);
+}
+
+template <typename T, typename Alloc>
+inline T convert_field(const char* first, const char* last,
+                       const parse_options& opt, std::string& scratch,
+                       const Alloc& alloc) {
+    T value = make_element<T>(alloc);
+    trim(first, last);
+    assert(first != last);
+    unquote(first, last, opt, scratch);
+    read_field(first, last, value, opt);
+    return value;
+}
+
+template <typename T, typename OutputIt, typename Alloc>
+inline void split_fields(const char* first, const char* last,
+                         const parse_options& opt, OutputIt out,
+                         const Alloc& alloc) {
+    field_scanner scanner(first, last, opt.comma(), opt,
+                          is_quotable<T>::value);
+    std::string scratch;
+    const char* pos;
+
+    while ((pos = scanner.next()) != last) {
+        assert(first < pos);
+
+        *out++ = convert_field<T>(first, pos, opt, scratch, alloc);
+        first = pos + 1;
+    }
+
+    *out++ = convert_field<T>(first, last, opt, scratch, alloc);
+}
+
+template <typename T>
+inline size_t count_fields(const char* first, const char* last,
+                           const parse_options& opt) {
+    field_scanner scanner(first, last, opt.comma(), opt,
+                          is_quotable<T>::value);
+    return scanner.count() + 1;
+}
+
+template <typename T, typename Alloc>
+inline void fill_sequence(const char* first, const char* last,
+                          const parse_options& opt, size_t size,
+                          std::vector<T, Alloc>& vec, std::true_type) {
+    vec.resize(size);
+    split_fields<T>(first, last, opt, vec.data(), vec.get_allocator());
+}
+
+template <typename T, typename Alloc>
+inline void fill_sequence(const char* first, const char* last,
+                          const parse_options& opt, size_t size,
+                          std::vector<T, Alloc>& vec, std::false_type) {
+    vec.reserve(size);
+    split_fields<T>(first, last, opt, std::back_inserter(vec),
+                    vec.get_allocator());
+}
+
+template <typename C>
+inline void parse_sequence(const char* first, const char* last,
+                           const parse_options& opt, C& c) {
+    typedef typename C::value_type value_t;
+
+    container_inserter<C> inserter(c);
+
+    if (container_traits<C>::reservable) {
+        inserter.reserve(count_fields<value_t>(first, last, opt));
+    }
+
+    split_fields<value_t>(first, last, opt, insert_output<C>(inserter),
+                          allocator_of(c, 0));
+    inserter.flush();
+}
+
+template <typename T, typename Alloc>
+inline void parse_sequence(const char* first, const char* last,
+                           const parse_options& opt,
+                           std::vector<T, Alloc>& vec) {
+    size_t size = count_fields<T>(first, last, opt);
+    fill_sequence(first, last, opt, size, vec, is_number<T>());
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+struct is_structured
+    : std::integral_constant<bool, is_composite<T>::value ||
+                                       is_reflectable<T>::value> {};
+
+template <typename T, int Kind = container_traits<T>::kind>
+struct is_nested : is_structured<T> {};
+
+template <typename T>
+struct is_nested<T, sequence_container>
+    : is_structured<typename T::value_type> {};
+
+template <typename T>
+struct is_nested<T, set_container> : is_structured<typename T::value_type> {};
+
+class reader {
+   public:
+    reader(const char* first, const char* last, const parse_options& opt)
+          : pos_(first), last_(last), opt_(opt) {}
+
+    const parse_options& options() const { return opt_; }
+
+    const char* tell() const { return pos_; }
+    void seek(const char* pos) { pos_ = pos; }
+
+    bool at_end() {
+        skip_space();
+        return pos_ == last_;
+    }
+
+    bool at_stop(const std::string& seps, char closer) {
+        skip_space();
+        return pos_ == last_ || *pos_ == closer || is_any_of(*pos_, seps);
+    }
+
+    bool consume(char c) {
+        skip_space();
+
+        if (pos_ != last_ && *pos_ == c) {
+            ++pos_;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool consume(const std::string& s) {
+        return s.empty() || consume(s[0]);
+    }
+
+    size_t count_until(const std::string& seps, char closer) {
+        skip_space();
+
+        const void* end = std::memchr(pos_, closer, last_ - pos_);
+        const char* last = end ? static_cast<const char*>(end) : last_;
+
+        return count_any_of(pos_, last, seps) + 1;
+    }
+
+    bool consume_any(const std::string& seps) {
+        skip_space();
+
+        if (pos_ != last_ && is_any_of(*pos_, seps)) {
+            ++pos_;
+            return true;
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    bool read_leaf(T& value, const std::string& seps, char closer) {
+        skip_space();
+
+        const char* first = pos_;
+        skip_quoted();
+
+        const bool delimited = is_delimiter(closer) &&
+                               all_delimiters(seps) &&
+                               all_delimiters(opt_.escape());
+
+        while (pos_ != last_) {
+            if (delimited && !is_delimiter(*pos_)) {
+                ++pos_;
+            } else if (*pos_ == closer || is_any_of(*pos_, seps)) {
+                break;
+            } else {
+                pos_ += escaped(pos_) ? 2 : 1;
+            }
+        }
+
+        const char* last = pos_;
+        trim(first, last);
+
+        if (first == last) {
+            return false;
+        }
+
+        unquote(first, last, opt_, scratch_);
+        return read_field(first, last, value, opt_);
+    }
+
+   private:
+    static bool is_delimiter(char c) {
+        return (class_of(c) & delimiter_class) != 0;
+    }
+
+    static bool all_delimiters(const std::string& s) {
+        return std::find_if_not(s.begin(), s.end(), is_delimiter) == s.end();
+    }
+
+    void skip_space() {
+        while (pos_ != last_ && is_space(*pos_)) {
+            ++pos_;
+        }
+    }
+
+    bool escaped(const char* p) const {
+        return !opt_.escape().empty() && *p == opt_.escape()[0] &&
+               p + 1 != last_;
+    }
+
+    void skip_quoted() {
+        if (opt_.quote().empty() || pos_ == last_ ||
+            *pos_ != opt_.quote()[0]) {
+            return;
+        }
+
+        const char quote = opt_.quote()[0];
+
+        for (++pos_; pos_ != last_; ++pos_) {
+            if (escaped(pos_)) {
+                ++pos_;
+            } else if (*pos_ == quote) {
+                if (pos_ + 1 == last_ || pos_[1] != quote) {
+                    ++pos_;
+                    return;
+                }
+
+                ++pos_;
+            }
+        }
+    }
+
+    const char* pos_;
+    const char* last_;
+    const parse_options& opt_;
+    std::string scratch_;
+};
+
+template <typename T>
+bool parse_value(reader& in, T& value, const std::string& seps, char closer);
+
+template <typename T1, typename T2>
+bool parse_value(reader& in, std::pair<T1, T2>& p, const std::string& seps,
+                 char closer);
+
+#if defined(CONV_HAS_CXX17)
+template <typename... Ts>
+bool parse_value(reader& in, std::tuple<Ts...>& t, const std::string& seps,
+                 char closer);
+
+template <typename T, size_t N>
+bool parse_value(reader& in, std::array<T, N>& a, const std::string& seps,
+                 char closer);
+
+template <typename T>
+bool parse_value(reader& in, std::optional<T>& o, const std::string& seps,
+                 char closer);
+
+template <typename... Ts>
+bool parse_value(reader& in, std::variant<Ts...>& v, const std::string& seps,
+                 char closer);
+#endif
+
+#if defined(CONV_HAS_CXX17)
+template <typename Tuple, size_t... Is>
+inline bool parse_elements(reader& in, Tuple&& t, std::index_sequence<Is...>) {
+    const parse_options& opt = in.options();
+
+    return in.consume('(') &&
+           ((((Is == 0 || in.consume_any(opt.comma())) &&
+              parse_value(in, std::get<Is>(t), opt.comma(), ')')) &&
+             ...)) &&
+           in.consume(')');
+}
+
+template <typename T>
+inline bool parse_object(reader& in, T& value, const std::string&, char,
+                         std::true_type) {
+    auto fields = tie_fields(value);
+    return parse_elements(
+        in, fields,
+        std::make_index_sequence<std::tuple_size<decltype(fields)>::value>());
+}
+
+template <typename... Ts>
+inline bool parse_value(reader& in, std::tuple<Ts...>& t, const std::string&,
+                        char) {
+    return parse_elements(in, t, std::index_sequence_for<Ts...>());
+}
+
+template <typename T, size_t N>
+inline bool parse_value(reader& in, std::array<T, N>& a,
+                        const std::string& seps, char closer) {
+    const parse_options& opt = in.options();
+    const char rbracket = opt.rbracket().empty() ? '\0' : opt.rbracket()[0];
+
+    if (N == 0 && in.at_stop(seps, closer)) {
+        return true;
+    }
+
+    if (!in.consume(opt.lbracket())) {
+        return false;
+    }
+
+    for (size_t i = 0; i < N; ++i) {
+        if ((i && !in.consume_any(opt.comma())) ||
+            !parse_value(in, a[i], opt.comma(), rbracket)) {
+            return false;
+        }
+    }
+
+    return in.consume(opt.rbracket());
+}
+
+template <typename T>
+inline bool parse_value(reader& in, std::optional<T>& o,
+                        const std::string& seps, char closer) {
+    if (in.at_stop(seps, closer)) {
+        o.reset();
+        return true;
+    }
+
+    return parse_value(in, o.emplace(), seps, closer);
+}
+
+template <size_t I, typename... Ts>
+inline bool parse_alternative(reader& in, std::variant<Ts...>& v,
+                              const std::string& seps, char closer) {
+    if constexpr (I == sizeof...(Ts)) {
+        return false;
+    } else {
+        const char* mark = in.tell();
+        std::variant_alternative_t<I, std::variant<Ts...> > value{};
+
+        if (parse_value(in, value, seps, closer) && in.at_stop(seps, closer)) {
+            v.template emplace<I>(std::move(value));
+            return true;
+        }
+
+        in.seek(mark);
+        return parse_alternative<I + 1>(in, v, seps, closer);
+    }
+}
+
+template <typename... Ts>
+inline bool parse_value(reader& in, std::variant<Ts...>& v,
+                        const std::string& seps, char closer) {
+    return parse_alternative<0>(in, v, seps, closer);
+}
+#endif
+
+template <typename T>
+inline bool parse_object(reader& in, T& value, const std::string& seps,
+                         char closer, std::false_type) {
+    return in.read_leaf(value, seps, closer);
+}
+
+template <typename T>
+inline bool parse_container(reader& in, T& value, const std::string& seps,
+                            char closer,
+                            std::integral_constant<int, no_container>) {
+    return parse_object(
+        in, value, seps, closer,
+        std::integral_constant<bool, is_reflectable<T>::value &&
+                                         !has_conv_parse<T>::value>());
+}
+
+template <typename C>
+inline bool parse_container(reader& in, C& c, const std::string& seps,
+                            char closer,
+                            std::integral_constant<int, sequence_container>) {
+    typedef typename C::value_type value_t;
+
+    const parse_options& opt = in.options();
+    const char rbracket = opt.rbracket().empty() ? '\0' : opt.rbracket()[0];
+
+    if (in.at_stop(seps, closer)) {
+        return true;
+    }
+
+    if (!in.consume(opt.lbracket())) {
+        return false;
+    }
+
+    if (rbracket && in.consume(rbracket)) {
+        return true;
+    }
+
+    do {
+        c.push_back(make_element<value_t>(allocator_of(c, 0)));
+
+        if (!parse_value(in, c.back(), opt.comma(), rbracket)) {
+            return false;
+        }
+    } while (in.consume_any(opt.comma()));
+
+    return in.consume(opt.rbracket());
+}
+
+template <typename C>
+inline bool parse_container(reader& in, C& c, const std::string& seps,
+                            char closer,
+                            std::integral_constant<int, set_container>) {
+    typedef typename C::value_type value_t;
+
+    const parse_options& opt = in.options();
+    const char rbracket = opt.rbracket().empty() ? '\0' : opt.rbracket()[0];
+
+    if (in.at_stop(seps, closer)) {
+        return true;
+    }
+
+    if (!in.consume(opt.lbracket())) {
+        return false;
+    }
+
+    if (rbracket && in.consume(rbracket)) {
+        return true;
+    }
+
+    container_inserter<C> inserter(c);
+
+    if (container_traits<C>::reservable && !is_composite<value_t>::value) {
+        inserter.reserve(in.count_until(opt.comma(), rbracket));
+    }
+
+    do {
+        value_t value = make_element<value_t>(allocator_of(c, 0));
+
+        if (!parse_value(in, value, opt.comma(), rbracket)) {
+            return false;
+        }
+
+        inserter.insert(std::move(value));
+    } while (in.consume_any(opt.comma()));
+
+    inserter.flush();
+    return in.consume(opt.rbracket());
+}
+
+template <typename C>
+inline bool parse_container(reader& in, C& m, const std::string& seps,
+                            char closer,
+                            std::integral_constant<int, map_container>) {
+    typedef typename C::key_type key_t;
+    typedef typename C::mapped_type mapped_t;
+
+    const parse_options& opt = in.options();
+
+    if (in.at_stop(seps, closer)) {
+        return true;
+    }
+
+    if (!in.consume('{')) {
+        return false;
+    }
+
+    if (in.consume('}')) {
+        return true;
+    }
+
+    container_inserter<C> inserter(m);
+
+    if (container_traits<C>::reservable && !is_composite<key_t>::value &&
+        !is_composite<mapped_t>::value) {
+        inserter.reserve(in.count_until(opt.comma(), '}'));
+    }
+
+    do {
+        std::pair<key_t, mapped_t> entry(
+            make_element<key_t>(allocator_of(m, 0)),
+            make_element<mapped_t>(allocator_of(m, 0)));
+
+        if (!parse_value(in, entry.first, opt.colon(), '}') ||
+            !in.consume_any(opt.colon()) ||
+            !parse_value(in, entry.second, opt.comma(), '}')) {
+            return false;
+        }
+
+        inserter.insert(std::move(entry));
+    } while (in.consume_any(opt.comma()));
+
+    inserter.flush();
+    return in.consume('}');
+}
+
+template <typename T>
+inline bool parse_value(reader& in, T& value, const std::string& seps,
+                        char closer) {
+    return parse_container(in, value, seps, closer, container_tag<T>());
+}
+
+template <typename T1, typename T2>
+inline bool parse_value(reader& in, std::pair<T1, T2>& p,
+                        const std::string&, char) {
+    const parse_options& opt = in.options();
+
+    return in.consume('(') && parse_value(in, p.first, opt.comma(), ')') &&
+           in.consume_any(opt.comma()) &&
+           parse_value(in, p.second, opt.comma(), ')') && in.consume(')');
+}
+
+template <typename T>
+inline void parse_top(const char* first, const char* last,
+                      const parse_options& opt, T& value, std::true_type) {
+    reader in(first, last, opt);
+
+    bool ok = parse_value(in, value, std::string(), '\0');
+    assert(ok && in.at_end());
+    (void)ok;
+}
+
+template <typename T>
+inline void parse_top(const char* first, const char* last,
+                      const parse_options& opt, T& value, std::false_type) {
+    strip_brackets(first, last, opt);
+    parse_sequence(first, last, opt, value);
+}
+
+}  // namespace internal
+
+template <typename T>
+inline size_t parse_into(T* out, size_t size, const std::string& str,
+                         const parse_options& opt = parse_options()) {
+    CONV_STAT_SCOPE(stat_parse);
+    CONV_PARSE_LATENCY_SCOPE(T*);
+    const char* first = str.data();
+    const char* last = first + str.size();
+    internal::strip_brackets(first, last, opt);
+
+    size_t count = internal::count_fields<T>(first, last, opt);
+    assert(count <= size);
+
+    if (count > size) {
+        return 0;
+    }
+
+    internal::split_fields<T>(first, last, opt, out, std::allocator<T>());
+    return count;
+}
+
+#if defined(CONV_HAS_SPAN)
+template <typename T, size_t Extent>
+inline size_t parse_into(std::span<T, Extent> out, const std::string& str,
+                         const parse_options& opt = parse_options()) {
+    return parse_into(out.data(), out.size(), str, opt);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
+template <typename... Ts>
+class columns : public std::tuple<std::vector<Ts>...> {
+   public:
+    typedef std::tuple<std::vector<Ts>...> tuple_t;
+
+    columns() : rows_(0) {}
+
+    template <size_t I>
+    typename std::tuple_element<I, tuple_t>::type& column() {
+        return std::get<I>(static_cast<tuple_t&>(*this));
+    }
+
+    template <size_t I>
+    const typename std::tuple_element<I, tuple_t>::type& column() const {
+        return std::get<I>(static_cast<const tuple_t&>(*this));
+    }
+
+    size_t rows() const { return rows_; }
+
+    void add_row() { ++rows_; }
+
+   private:
+    size_t rows_;
+};
+
+namespace internal {
+
+template <size_t... Is>
+struct index_sequence {};
+
+template <size_t N, size_t... Is>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, Is...> {};
+
+template <size_t... Is>
+struct make_index_sequence<0, Is...> : index_sequence<Is...> {};
+
+template <typename ColumnsT, size_t I>
+inline void append_column(ColumnsT& cols, const char* first, const char* last,
+                          const parse_options& opt, std::string& scratch) {
+    typedef typename std::tuple_element<I, typename ColumnsT::tuple_t>::type
+        column_t;
+    typedef typename column_t::value_type value_t;
+
+    value_t value = value_t();
+
+    trim(first, last);
+    unquote(first, last, opt, scratch);
+
+    if (first != last) {
+        read_field(first, last, value, opt);
+    }
+
+    cols.template column<I>().push_back(std::move(value));
+}
+
+template <typename... Ts>
+class column_reader {
+   public:
+    typedef columns<Ts...> columns_t;
+    typedef void (*append_t)(columns_t&, const char*, const char*,
+                             const parse_options&, std::string&);
+
+    column_reader(columns_t& cols, const parse_options& opt)
+          : cols_(cols), opt_(opt), delims_(opt.comma() + "\n") {}
+
+    void read(const char* first, const char* last) {
+        reserve(count_any_of(first, last, "\n") + 1,
+                make_index_sequence<sizeof...(Ts)>());
+
+        field_scanner scanner(first, last, delims_, opt_,
+                              any_quotable<Ts...>::value);
+        size_t column = 0;
+
+        for (;;) {
+            const char* pos = scanner.next();
+            bool eol = pos == last || *pos == '\n';
+
+            if (!(eol && column == 0 && blank(first, pos))) {
+                append(column++, first, pos);
+
+                if (eol) {
+                    for (; column < sizeof...(Ts); ++column) {
+                        append(column, pos, pos);
+                    }
+
+                    cols_.add_row();
+                    column = 0;
+                }
+            }
+
+            if (pos == last) {
+                break;
+            }
+
+            first = pos + 1;
+        }
+    }
+
+   private:
+    template <size_t... Is>
+    void reserve(size_t rows, index_sequence<Is...>) {
+        int expand[] = {0, (cols_.template column<Is>().reserve(rows), 0)...};
+        (void)expand;
+    }
+
+    template <size_t... Is>
+    static append_t appender(size_t i, index_sequence<Is...>) {
+        static const append_t table[] = {&append_column<columns_t, Is>...};
+        return table[i];
+    }
+
+    void append(size_t column, const char* first, const char* last) {
+        if (column < sizeof...(Ts)) {
+            appender(column, make_index_sequence<sizeof...(Ts)>())(
+                cols_, first, last, opt_, scratch_);
+        }
+    }
+
+    static bool blank(const char* first, const char* last) {
+        trim(first, last);
+        return first == last;
+    }
+
+    columns_t& cols_;
+    const parse_options& opt_;
+    std::string delims_;
+    std::string scratch_;
+};
+
+template <typename T>
+inline void parse_document(const char* first, const char* last,
+                           const parse_options& opt, T& value) {
+    parse_top(first, last, opt, value, is_nested<T>());
+}
+
+template <typename... Ts>
+inline void parse_document(const char* first, const char* last,
+                           const parse_options& opt, columns<Ts...>& cols) {
+    column_reader<Ts...>(cols, opt).read(first, last);
+}
+
+}  // namespace internal
+
+template <typename T>
+inline T parse(const std::string& str,
+               const parse_options& opt = parse_options()) {
+    CONV_STAT_SCOPE(stat_parse);
+    CONV_PARSE_LATENCY_SCOPE(T);
+    T value = T();
+    internal::parse_document(str.data(), str.data() + str.size(), opt, value);
+
+    return value;
+}
+
+template <typename T, typename Alloc>
+inline typename std::enable_if<
+    !std::is_convertible<Alloc, parse_options>::value, T>::type
+parse(const std::string& str, const Alloc& alloc,
+      const parse_options& opt = parse_options()) {
+    CONV_STAT_SCOPE(stat_parse);
+    CONV_PARSE_LATENCY_SCOPE(T);
+    T value(alloc);
+    internal::parse_document(str.data(), str.data() + str.size(), opt, value);
+
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+inline std::ostream& operator<<(std::ostream& out, const to<T>& value) {
+    out << static_cast<T>(value);
+    return out;
 }
 
 template <typename T>
@@ -535,91 +5088,124 @@ inline std::wostream& operator<<(std::wostream& out,
 
 //-----------------------------------------------------------------------------
 
-template <typename T>
-inline std::ostream& operator<<(std::ostream& out, const std::vector<T>& v) {
-    if (v.empty()) {
+namespace internal {
+
+template <typename CharT, typename Traits, typename Iterator>
+inline void stream_element(std::basic_ostream<CharT, Traits>& out,
+                           Iterator iter, std::false_type) {
+    out << *iter;
+}
+
+template <typename CharT, typename Traits, typename Iterator>
+inline void stream_element(std::basic_ostream<CharT, Traits>& out,
+                           Iterator iter, std::true_type) {
+    out << iter->first << ": " << iter->second;
+}
+
+template <typename CharT, typename Traits, typename C>
+inline std::basic_ostream<CharT, Traits>& stream_container(
+    std::basic_ostream<CharT, Traits>& out, const C& c) {
+    if (c.empty()) {
         return out;
     }
 
-    typedef typename std::vector<T>::const_iterator iterator;
+    typedef typename C::const_iterator iterator;
+    typedef std::integral_constant<
+        bool, container_traits<C>::kind == map_container> is_map;
     const char* sep = "";
 
-    out << "[";
+    out << (is_map::value ? "{" : "[");
 
-    for (iterator iter = v.begin(); iter != v.end(); ++iter) {
-        out << sep << *iter;
+    for (iterator iter = c.begin(); iter != c.end(); ++iter) {
+        out << sep;
+        stream_element(out, iter, is_map());
         sep = ", ";
     }
 
-    out << "]";
+    out << (is_map::value ? "}" : "]");
 
     return out;
 }
 
+}  // namespace internal
+
+template <typename T>
+inline std::ostream& operator<<(std::ostream& out, const std::vector<T>& v) {
+    return internal::stream_container(out, v);
+}
+
 template <typename T>
 inline std::wostream& operator<<(std::wostream& out, const std::vector<T>& v) {
-    if (v.empty()) {
-        return out;
-    }
+    return internal::stream_container(out, v);
+}
 
-    typedef typename std::vector<T>::const_iterator iterator;
-    const wchar_t* sep = L"";
+template <typename CharT, typename Traits, typename T, typename Alloc>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out, const std::deque<T, Alloc>& d) {
+    return internal::stream_container(out, d);
+}
 
-    out << L"[";
+template <typename CharT, typename Traits, typename T, typename Alloc>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out, const std::list<T, Alloc>& l) {
+    return internal::stream_container(out, l);
+}
 
-    for (iterator iter = v.begin(); iter != v.end(); ++iter) {
-        out << sep << *iter;
-        sep = L", ";
-    }
+template <typename CharT, typename Traits, typename T, typename Compare,
+          typename Alloc>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::set<T, Compare, Alloc>& s) {
+    return internal::stream_container(out, s);
+}
 
-    out << L"]";
+template <typename CharT, typename Traits, typename T, typename Hash,
+          typename Pred, typename Alloc>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::unordered_set<T, Hash, Pred, Alloc>& s) {
+    return internal::stream_container(out, s);
+}
 
-    return out;
+#if defined(CONV_HAS_FLAT_SET)
+template <typename CharT, typename Traits, typename T, typename Compare,
+          typename KeyContainer>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::flat_set<T, Compare, KeyContainer>& s) {
+    return internal::stream_container(out, s);
 }
+#endif
 
 //-----------------------------------------------------------------------------
 
 template <typename K, typename V>
 inline std::ostream& operator<<(std::ostream& out, const std::map<K, V>& m) {
-    if (m.empty()) {
-        return out;
-    }
-
-    typedef typename std::map<K, V>::const_iterator iterator;
-    const char* sep = "";
-
-    out << "{";
-
-    for (iterator iter = m.begin(); iter != m.end(); ++iter) {
-        out << sep << iter->first << ": " << iter->second;
-        sep = ", ";
-    }
-
-    out << "}";
-
-    return out;
+    return internal::stream_container(out, m);
 }
 
 template <typename K, typename V>
 inline std::wostream& operator<<(std::wostream& out, const std::map<K, V>& m) {
-    if (m.empty()) {
-        return out;
-    }
-
-    typedef typename std::map<K, V>::const_iterator iterator;
-    const wchar_t* sep = L"";
-
-    out << L"{";
-
-    for (iterator iter = m.begin(); iter != m.end(); ++iter) {
-        out << sep << iter->first << L": " << iter->second;
-        sep = L", ";
-    }
+    return internal::stream_container(out, m);
+}
 
-    out << L"}";
+template <typename CharT, typename Traits, typename K, typename V,
+          typename Hash, typename Pred, typename Alloc>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::unordered_map<K, V, Hash, Pred, Alloc>& m) {
+    return internal::stream_container(out, m);
+}
 
-    return out;
+#if defined(CONV_HAS_FLAT_MAP)
+template <typename CharT, typename Traits, typename K, typename V,
+          typename Compare, typename KeyContainer, typename MappedContainer>
+inline std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& out,
+    const std::flat_map<K, V, Compare, KeyContainer, MappedContainer>& m) {
+    return internal::stream_container(out, m);
 }
+#endif
 
 }  // namespace conv
 
@@ -26,19 +26,49 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <array>
+#include <clocale>
+#include <deque>
+#include <list>
 #include <map>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+#include <set>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <conv/conv.h>
 
+#if defined(CONV_ENABLE_STATS)
+CONV_DEFINE_ALLOCATION_HOOKS
+#endif
+
 using conv::parse;
 using conv::to;
 
 using conv::lbracket;
 using conv::rbracket;
 using conv::comma;
+using conv::colon;
+
+TEST_CASE("version", "[version]") {
+    REQUIRE(conv::version() == "0.3.4");
+    REQUIRE(conv::version() != std::string("0.3"));
+    REQUIRE(conv::version().size() == 5);
+
+    const std::string& v = conv::version();
+    REQUIRE(v == conv::version().c_str());
+
+    std::ostringstream out;
+    out << conv::version();
+    REQUIRE(out.str() == "0.3.4");
+}
 
 TEST_CASE("string -> int", "[string]") {
     REQUIRE(to<int>("1234") == 1234);
@@ -47,6 +77,24 @@ TEST_CASE("string -> int", "[string]") {
     REQUIRE(to<int>("  1234  ") == 1234);
     REQUIRE(to<int>("001234") == 1234);
     REQUIRE(to<int>("0000") == 0);
+
+    std::string padded =
+        std::string(20, ' ') + "\t1234\r\n" + std::string(33, ' ');
+    REQUIRE(to<int>(padded) == 1234);
+    REQUIRE(to<int>(std::string(17, ' ') + "5") == 5);
+    REQUIRE(to<int>("5" + std::string(17, '\n')) == 5);
+}
+
+TEST_CASE("string -> double out of range", "[string]") {
+    const double inf = std::numeric_limits<double>::infinity();
+
+    REQUIRE(to<double>("1e400") == inf);
+    REQUIRE(to<double>("-1e400") == -inf);
+    REQUIRE(to<double>("1e-400") == 0.0);
+    REQUIRE(to<float>("1e39") == std::numeric_limits<float>::infinity());
+    REQUIRE(to<float>("-1e-50") == 0.0f);
+    REQUIRE(to<double>("4.9e-324") ==
+            std::numeric_limits<double>::denorm_min());
 }
 
 TEST_CASE("hex string -> int", "[string]") {
@@ -65,9 +113,27 @@ TEST_CASE("string -> char", "[char]") {
 
 TEST_CASE("string -> bool", "[bool]") {
     REQUIRE(to<bool>("") == false);
-    REQUIRE(to<bool>("  ") == true);
+    REQUIRE(to<bool>("  ") == false);
     REQUIRE(to<bool>("true") == true);
-    REQUIRE(to<bool>("false") == true);
+    REQUIRE(to<bool>("false") == false);
+    REQUIRE(to<bool>(" TRUE ") == true);
+    REQUIRE(to<bool>("Yes") == true);
+    REQUIRE(to<bool>("off") == false);
+    REQUIRE(to<bool>("1") == true);
+    REQUIRE(to<bool>(L"on") == true);
+    REQUIRE(to<bool>("truest") == false);
+    REQUIRE(to<bool>("yes", conv::bool_true_false) == false);
+
+    typedef conv::columns<int, bool> table_t;
+    table_t t =
+        parse<table_t>("1,Yes\n2,1\n", conv::booleans(conv::bool_yes_no));
+    REQUIRE(t.column<1>()[0] == true);
+    REQUIRE(t.column<1>()[1] == false);
+
+    t = parse<table_t>("1,yes\n2,0\n3,OFF\n");
+    REQUIRE(t.column<1>()[0] == true);
+    REQUIRE(t.column<1>()[1] == false);
+    REQUIRE(t.column<1>()[2] == false);
 }
 
 TEST_CASE("pair -> string", "[pair]") {
@@ -110,3 +176,777 @@ TEST_CASE("parse string", "[string]") {
     REQUIRE(parse<vector_t>("[0[1[2]", comma("[")) == v);
     REQUIRE(parse<vector_t>("[0]1]2]", comma("]")) == v);
 }
+
+TEST_CASE("parse into contiguous storage", "[string]") {
+    int a[4] = {0};
+
+    REQUIRE(conv::parse_into(a, 4, "[3, 4, 5]") == 3);
+    REQUIRE(a[0] == 3);
+    REQUIRE(a[1] == 4);
+    REQUIRE(a[2] == 5);
+    REQUIRE(a[3] == 0);
+
+    std::vector<double> d = parse<std::vector<double> >("[0.5, -1.25, 1e3]");
+    REQUIRE(d.size() == 3);
+    REQUIRE(d[0] == 0.5);
+    REQUIRE(d[1] == -1.25);
+    REQUIRE(d[2] == 1000.0);
+
+    std::vector<std::string> s = parse<std::vector<std::string> >("[a, b]");
+    REQUIRE(s.size() == 2);
+    REQUIRE(s[1] == "b");
+}
+
+TEST_CASE("parse nested containers", "[string]") {
+    typedef std::vector<std::vector<int> > matrix_t;
+
+    matrix_t m = parse<matrix_t>("[[1, 2], [3, 4, 5]]");
+    REQUIRE(m.size() == 2);
+    REQUIRE(m[0].size() == 2);
+    REQUIRE(m[1].size() == 3);
+    REQUIRE(m[1][2] == 5);
+    REQUIRE(to<std::string>(m) == "[[1, 2], [3, 4, 5]]");
+
+    typedef std::vector<std::pair<std::string, double> > pairs_t;
+
+    pairs_t p = parse<pairs_t>("[(a, 0.5), (b, 1.5)]");
+    REQUIRE(p.size() == 2);
+    REQUIRE(p[1].first == "b");
+    REQUIRE(p[1].second == 1.5);
+
+    typedef std::map<std::string, std::vector<int> > map_t;
+
+    map_t mv = parse<map_t>("{a: [0, 1], b: [2]}");
+    REQUIRE(mv.size() == 2);
+    REQUIRE(mv["a"].size() == 2);
+    REQUIRE(mv["b"][0] == 2);
+    REQUIRE(to<std::string>(mv) == "{a: [0, 1], b: [2]}");
+}
+
+TEST_CASE("parse map", "[map]") {
+    std::map<std::string, int> m;
+    m["a"] = 0;
+    m["b"] = 1;
+    m["c"] = 2;
+
+    typedef std::map<std::string, int> map_t;
+    REQUIRE(parse<map_t>(to<std::string>(m)) == m);
+    REQUIRE(parse<map_t>("{c: 2, a: 0, b: 1}") == m);
+    REQUIRE(parse<map_t>("{a=0; b=1; c=2}", colon("=").comma(";")) == m);
+
+    typedef std::unordered_map<std::string, int> umap_t;
+    umap_t u = parse<umap_t>("{a: 0, b: 1, c: 2}");
+    REQUIRE(u.size() == 3);
+    REQUIRE(u["c"] == 2);
+}
+
+TEST_CASE("map -> map", "[map]") {
+    std::map<int, int> m;
+    m[1] = 10;
+    m[2] = 20;
+    m[10] = 100;
+
+    typedef std::map<std::string, double> map_t;
+
+    map_t converted = to<map_t>(m);
+    REQUIRE(converted.size() == 3);
+    REQUIRE(converted["10"] == 100.0);
+    REQUIRE(converted.begin()->first == "1");
+
+    std::map<std::string, int> colliding;
+    colliding["01"] = 1;
+    colliding["1"] = 2;
+    colliding["2"] = 3;
+
+    std::map<int, int> last = to<std::map<int, int> >(colliding);
+    REQUIRE(last.size() == 2);
+    REQUIRE(last[1] == 2);
+
+    std::unordered_map<int, int> hashed =
+        to<std::unordered_map<int, int> >(colliding);
+    REQUIRE(hashed.size() == 2);
+    REQUIRE(hashed[1] == 2);
+
+    std::map<int, int> parsed = parse<std::map<int, int> >("{1: 5, 1: 6}");
+    REQUIRE(parsed[1] == 6);
+}
+
+template <typename T>
+static std::string stream_format(const T& value) {
+    using conv::operator<<;
+
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+TEST_CASE("container formatting matches operator<<", "[vector]") {
+    std::vector<int> i;
+    i.push_back(-2147483647 - 1);
+    i.push_back(0);
+    i.push_back(1234567);
+    REQUIRE(to<std::string>(i) == stream_format(i));
+
+    std::vector<double> d;
+    d.push_back(3.14);
+    d.push_back(-1e-7);
+    d.push_back(123456789.0);
+    d.push_back(0.1f);
+    REQUIRE(to<std::string>(d) == stream_format(d));
+    REQUIRE(to<std::string>(3.14) == "3.14");
+
+    std::vector<char> c;
+    c.push_back('x');
+    c.push_back('y');
+    REQUIRE(to<std::string>(c) == "[x, y]");
+
+    std::vector<bool> b;
+    b.push_back(true);
+    b.push_back(false);
+    REQUIRE(to<std::string>(b) == stream_format(b));
+
+    std::map<int, std::vector<std::pair<int, double> > > m;
+    m[1].push_back(std::make_pair(2, 0.5));
+    m[3];
+    REQUIRE(to<std::string>(m) == stream_format(m));
+    REQUIRE((to<std::wstring>(m) == L"{1: [(2, 0.5)], 3: }"));
+
+    std::deque<int> dq = parse<std::deque<int> >("[3, 1]");
+    REQUIRE(stream_format(dq) == "[3, 1]");
+    std::list<std::string> l = to<std::list<std::string> >(dq);
+    REQUIRE(stream_format(l) == to<std::string>(l));
+    std::set<int> s = to<std::set<int> >(dq);
+    REQUIRE(stream_format(s) == "[1, 3]");
+    std::vector<std::set<int> > vs(1, s);
+    REQUIRE(stream_format(vs) == to<std::string>(vs));
+    std::unordered_set<int> us = to<std::unordered_set<int> >(l);
+    REQUIRE(stream_format(us).size() == to<std::string>(us).size());
+
+    std::unordered_map<int, std::list<int> > um;
+    um[1].push_back(2);
+    REQUIRE(stream_format(um) == "{1: [2]}");
+
+    using conv::operator<<;
+    std::wostringstream wout;
+    wout << s;
+    REQUIRE((wout.str() == L"[1, 3]"));
+}
+
+#if defined(CONV_HAS_FLAT_MAP) && defined(CONV_HAS_FLAT_SET)
+TEST_CASE("flat containers", "[containers]") {
+    std::vector<std::string> v = parse<std::vector<std::string> >("[2, 1, 2]");
+
+    std::flat_set<int> s = to<std::flat_set<int> >(v);
+    REQUIRE(s.size() == 2);
+    REQUIRE(to<std::string>(s) == "[1, 2]");
+    REQUIRE(stream_format(s) == "[1, 2]");
+
+    typedef std::flat_map<int, int> flat_map_t;
+    flat_map_t m = parse<flat_map_t>("{2: 20, 1: 10, 2: 21}");
+    REQUIRE(m.size() == 2);
+    REQUIRE(m[2] == 21);
+    REQUIRE(to<std::string>(m) == "{1: 10, 2: 21}");
+    REQUIRE(stream_format(m) == "{1: 10, 2: 21}");
+
+    std::map<std::string, int> colliding;
+    colliding["01"] = 1;
+    colliding["1"] = 2;
+    REQUIRE(to<flat_map_t>(colliding)[1] == 2);
+}
+#endif
+
+TEST_CASE("formatted size", "[size]") {
+    REQUIRE(conv::formatted_size(0) == 1);
+    REQUIRE(conv::formatted_size(-10) == 3);
+    REQUIRE(conv::formatted_size(18446744073709551615ULL) == 20);
+    REQUIRE(conv::formatted_size(3.14) == 4);
+    REQUIRE(conv::formatted_size(true) == 4);
+    REQUIRE(conv::formatted_size(static_cast<char>(-5)) == 2);
+    REQUIRE(conv::formatted_size("abc") == 3);
+
+    std::map<std::string, std::vector<std::pair<int, double> > > m;
+    m["a"].push_back(std::make_pair(10, 0.25));
+    m["b"].push_back(std::make_pair(-1, 1e30));
+    m["c"];
+    REQUIRE(conv::formatted_size(m) == to<std::string>(m).size());
+
+    for (unsigned long long x = 1; x < 10000000000000000000ULL; x *= 10) {
+        REQUIRE(conv::formatted_size(x - 1) == to<std::string>(x - 1).size());
+        REQUIRE(conv::formatted_size(x) == to<std::string>(x).size());
+    }
+}
+
+TEST_CASE("vector -> string column", "[vector]") {
+    std::vector<long long> v;
+    v.push_back(0);
+    v.push_back(-9223372036854775807LL - 1);
+    v.push_back(42);
+
+    conv::string_column col = to<conv::string_column>(v);
+    REQUIRE(col.size() == 3);
+    REQUIRE(col.chars() == "0-922337203685477580842");
+    REQUIRE(col.offsets()[1] == 1);
+    REQUIRE(col.offsets()[3] == col.chars().size());
+    REQUIRE(col.str(1) == "-9223372036854775808");
+    REQUIRE(col.str(2) == "42");
+
+    std::vector<double> d;
+    d.push_back(0.5);
+    d.push_back(-2);
+
+    conv::string_column dcol = to<conv::string_column>(d);
+    REQUIRE(dcol.chars() == "0.5-2");
+    REQUIRE(dcol.str(1) == "-2");
+
+    std::vector<bool> b;
+    b.push_back(true);
+    b.push_back(false);
+
+    conv::string_column bcol = to<conv::string_column>(b);
+    REQUIRE(bcol.str(0) == to<std::string>(true));
+    REQUIRE(bcol.chars() == "truefalse");
+}
+
+TEST_CASE("parse columns", "[columns]") {
+    typedef conv::columns<int, double, std::string> table_t;
+
+    table_t t = parse<table_t>(
+        "1, 0.5, apple\n"
+        "2, 1.5, \"banana, ripe\"\r\n"
+        "\n"
+        "3, 2.5, \"say \"\"hi\"\"\"\n"
+        "4\n");
+
+    REQUIRE(t.rows() == 4);
+    REQUIRE(t.column<0>().size() == 4);
+    REQUIRE(t.column<0>()[3] == 4);
+    REQUIRE(t.column<1>()[1] == 1.5);
+    REQUIRE(t.column<1>()[3] == 0.0);
+    REQUIRE(t.column<2>()[0] == "apple");
+    REQUIRE(t.column<2>()[1] == "banana, ripe");
+    REQUIRE(t.column<2>()[2] == "say \"hi\"");
+    REQUIRE(std::get<2>(t)[3] == "");
+
+    table_t tsv = parse<table_t>("7\t8.5\tx", comma("\t"));
+    REQUIRE(tsv.rows() == 1);
+    REQUIRE(tsv.column<0>()[0] == 7);
+    REQUIRE(tsv.column<2>()[0] == "x");
+}
+
+TEST_CASE("parse quoted fields", "[string]") {
+    typedef std::vector<std::string> vector_t;
+
+    vector_t v = parse<vector_t>("[\"a, b\", c, \"say \"\"hi\"\"\"]");
+    REQUIRE(v.size() == 3);
+    REQUIRE(v[0] == "a, b");
+    REQUIRE(v[1] == "c");
+    REQUIRE(v[2] == "say \"hi\"");
+
+    v = parse<vector_t>("[\"a\\\", b\", c\\,d]", conv::escape("\\"));
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[0] == "a\", b");
+    REQUIRE(v[1] == "c,d");
+
+    v = parse<vector_t>("[\"a\\\\\", c]", conv::escape("\\"));
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[0] == "a\\");
+    REQUIRE(v[1] == "c");
+
+    v = parse<vector_t>("['x, y', z]", conv::quote("'"));
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[0] == "x, y");
+
+    std::string text = "[";
+    for (int i = 0; i < 50; ++i) {
+        text += i % 3 ? "\"q,q,q\", " : "plain, ";
+    }
+    text += "end]";
+
+    v = parse<vector_t>(text);
+    REQUIRE(v.size() == 51);
+    REQUIRE(v[1] == "q,q,q");
+    REQUIRE(v[48] == "plain");
+    REQUIRE(v[50] == "end");
+
+    typedef std::map<std::string, int> map_t;
+    map_t m = parse<map_t>("{\"a: b\": 1, c: 2}");
+    REQUIRE(m["a: b"] == 1);
+    REQUIRE(m["c"] == 2);
+
+    typedef conv::columns<std::string, int> table_t;
+    table_t t = parse<table_t>("\"multi\nline\", 1\nx, 2\n");
+    REQUIRE(t.rows() == 2);
+    REQUIRE(t.column<0>()[0] == "multi\nline");
+    REQUIRE(t.column<1>()[1] == 2);
+
+    std::vector<int> n = parse<std::vector<int> >("[\"1\", 2, \"3\"]");
+    REQUIRE(n.size() == 3);
+    REQUIRE(n[0] == 1);
+    REQUIRE(n[2] == 3);
+
+    typedef conv::columns<int, double> numbers_t;
+    numbers_t nums = parse<numbers_t>("1,\"0.5\"\n2,1.5\n");
+    REQUIRE(nums.rows() == 2);
+    REQUIRE(nums.column<1>()[0] == 0.5);
+}
+
+struct point {
+    int x;
+    int y;
+};
+
+static std::ostream& operator<<(std::ostream& out, const point& p) {
+    out << "<" << p.x << " " << p.y << " " << to<std::string>(p.x * 0.5)
+        << ">";
+    return out;
+}
+
+struct nested_point {
+    point p;
+};
+
+static std::ostream& operator<<(std::ostream& out, const nested_point& n) {
+    out << "{" << to<std::string>(n.p) << "}";
+    return out;
+}
+
+TEST_CASE("user type -> string", "[user]") {
+    point p = {3, 4};
+    REQUIRE(to<std::string>(p) == "<3 4 1.5>");
+
+    nested_point n = {p};
+    REQUIRE(to<std::string>(n) == "{<3 4 1.5>}");
+
+    std::vector<point> v(2, p);
+    REQUIRE(to<std::string>(v) == "[<3 4 1.5>, <3 4 1.5>]");
+}
+
+namespace market {
+
+struct price {
+    long long cents;
+};
+
+inline void conv_format(conv::sink& out, const price& p) {
+    out << p.cents / 100 << "." << (p.cents % 100 < 10 ? "0" : "")
+        << p.cents % 100;
+}
+
+inline bool conv_parse(const conv::source& in, price& p) {
+    double value = 0;
+
+    if (!in.read(value)) {
+        return false;
+    }
+
+    p.cents = static_cast<long long>(value * 100 + 0.5);
+    return true;
+}
+
+}  // namespace market
+
+TEST_CASE("customization point", "[user]") {
+    market::price p = {1205};
+    REQUIRE(to<std::string>(p) == "12.05");
+    REQUIRE(conv::formatted_size(p) == 5);
+
+    std::vector<market::price> v(2, p);
+    REQUIRE(to<std::string>(v) == "[12.05, 12.05]");
+
+    std::vector<market::price> parsed =
+        parse<std::vector<market::price> >("[1.5, 0.25]");
+    REQUIRE(parsed.size() == 2);
+    REQUIRE(parsed[0].cents == 150);
+    REQUIRE(parsed[1].cents == 25);
+
+    market::price q = to<market::price>(" 3.99 ");
+    REQUIRE(q.cents == 399);
+}
+
+#if __cplusplus >= 201703L
+namespace shop {
+
+enum class status { open, closed, pending };
+
+constexpr std::array<conv::enum_entry<status>, 3> conv_enum_names(status) {
+    return {{{status::open, "open"},
+             {status::closed, "closed"},
+             {status::pending, "pending"}}};
+}
+
+enum level { low = 10, high = 20 };
+
+constexpr std::array<conv::enum_entry<level>, 2> conv_enum_names(level) {
+    return {{{low, "low"}, {high, "high"}}};
+}
+
+}  // namespace shop
+
+TEST_CASE("enum <-> string", "[enum]") {
+    shop::status s = to<shop::status>("closed");
+    REQUIRE(s == shop::status::closed);
+    s = to<shop::status>(" pending ");
+    REQUIRE(s == shop::status::pending);
+    shop::level l = to<shop::level>("high");
+    REQUIRE(l == shop::high);
+
+    REQUIRE(to<std::string>(shop::status::pending) == "pending");
+    REQUIRE(to<std::string>(shop::high) == "high");
+    REQUIRE(to<std::string>(static_cast<shop::level>(7)) == "7");
+    std::string seven = to<std::string>(static_cast<shop::level>(7));
+    l = to<shop::level>(seven);
+    REQUIRE(l == 7);
+    std::wstring w = to<std::wstring>(shop::status::open);
+    REQUIRE(w == L"open");
+
+    std::string_view name = to<std::string_view>(shop::status::closed);
+    REQUIRE(name == "closed");
+    REQUIRE(name.data() == to<std::string_view>(shop::status::closed).data());
+    REQUIRE(to<std::string_view>(static_cast<shop::level>(7)).empty());
+
+    std::vector<shop::status> v =
+        parse<std::vector<shop::status> >("[open, pending]");
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[1] == shop::status::pending);
+    REQUIRE(to<std::string>(v) == "[open, pending]");
+}
+
+struct order {
+    int id;
+    double qty;
+    std::string symbol;
+    std::vector<int> fills;
+};
+
+// Brace initialization counts C array elements and base classes, which
+// structured bindings don't, so these fall back to operator<<.
+struct with_array {
+    int a[2];
+    int b;
+};
+
+static std::ostream& operator<<(std::ostream& out, const with_array& w) {
+    return out << "<" << w.a[0] << " " << w.a[1] << " " << w.b << ">";
+}
+
+struct sixteen {
+    int a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p;
+};
+
+struct seventeen {
+    int a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q;
+};
+
+struct raw_array {
+    int a[2];
+    int b;
+};
+
+struct with_base : order {
+    int extra;
+};
+
+struct empty_base : std::less<int> {
+    int x;
+};
+
+TEST_CASE("aggregate <-> string", "[user]") {
+    order o = {7, 1.5, "ABC", std::vector<int>(2, 3)};
+    REQUIRE(to<std::string>(o) == "(7, 1.5, ABC, [3, 3])");
+
+    order p = parse<order>("(8, 2.5, XYZ, [1, 2])");
+    REQUIRE(p.id == 8);
+    REQUIRE(p.qty == 2.5);
+    REQUIRE(p.symbol == "XYZ");
+    REQUIRE(p.fills.size() == 2);
+
+    std::vector<order> v = parse<std::vector<order> >(
+        "[(1, 0.5, A, [1]), (2, 1, B, [2, 3])]");
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[1].fills[1] == 3);
+    REQUIRE(to<std::string>(v) == "[(1, 0.5, A, [1]), (2, 1, B, [2, 3])]");
+
+    REQUIRE(conv::internal::is_reflectable<order>::value);
+    REQUIRE(!conv::internal::is_reflectable<raw_array>::value);
+    REQUIRE(!conv::internal::is_reflectable<seventeen>::value);
+
+    sixteen x = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    REQUIRE(to<std::string>(x) ==
+            "(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16)");
+    REQUIRE(!conv::internal::is_reflectable<with_base>::value);
+    REQUIRE(!conv::internal::is_reflectable<empty_base>::value);
+
+    with_array a = {{1, 2}, 3};
+    REQUIRE(to<std::string>(a) == "<1 2 3>");
+}
+#endif
+
+#if __cplusplus >= 201703L
+TEST_CASE("tuple, array, optional and variant", "[tuple]") {
+    typedef std::tuple<int, std::string, double> tuple_t;
+
+    tuple_t t(1, "a", 0.5);
+    REQUIRE(to<std::string>(t) == "(1, a, 0.5)");
+    REQUIRE(parse<tuple_t>("(2, b, 1.5)") == tuple_t(2, "b", 1.5));
+
+    std::tuple<std::string, long> tc = to<std::tuple<std::string, long> >(
+        std::tuple<int, std::string>(3, "42"));
+    REQUIRE(std::get<0>(tc) == "3");
+    REQUIRE(std::get<1>(tc) == 42);
+
+    std::array<int, 3> a = {{1, 2, 3}};
+    REQUIRE(to<std::string>(a) == "[1, 2, 3]");
+    std::array<int, 3> b = {{4, 5, 6}};
+    REQUIRE((parse<std::array<int, 3> >("[4, 5, 6]") == b));
+
+    std::vector<std::optional<int> > o =
+        parse<std::vector<std::optional<int> > >("[1, , 3]");
+    REQUIRE(o.size() == 3);
+    REQUIRE(*o[0] == 1);
+    REQUIRE(!o[1]);
+    REQUIRE(to<std::string>(o) == "[1, , 3]");
+
+    typedef std::variant<int, double, std::string> variant_t;
+
+    std::vector<variant_t> v = parse<std::vector<variant_t> >("[1, 2.5, x]");
+    REQUIRE(v[0].index() == 0);
+    REQUIRE(v[1].index() == 1);
+    REQUIRE(std::get<std::string>(v[2]) == "x");
+    REQUIRE(to<std::string>(v) == "[1, 2.5, x]");
+}
+#endif
+
+TEST_CASE("other STL containers", "[containers]") {
+    std::deque<int> d = parse<std::deque<int> >("[3, 1, 2]");
+    REQUIRE(d.size() == 3);
+    REQUIRE(to<std::string>(d) == "[3, 1, 2]");
+
+    std::list<std::string> l = to<std::list<std::string> >(d);
+    REQUIRE(l.front() == "3");
+    REQUIRE(to<std::string>(l) == "[3, 1, 2]");
+
+    std::set<int> s = to<std::set<int> >(l);
+    REQUIRE(to<std::string>(s) == "[1, 2, 3]");
+    REQUIRE(parse<std::set<std::string> >("[b, a, b]").size() == 2);
+
+    std::unordered_set<int> us = parse<std::unordered_set<int> >("[1, 2, 2]");
+    REQUIRE(us.size() == 2);
+    REQUIRE(us.count(2) == 1);
+
+    std::map<std::string, std::string> m;
+    m["a"] = "1";
+    std::unordered_map<std::string, int> um =
+        to<std::unordered_map<std::string, int> >(m);
+    REQUIRE(um["a"] == 1);
+    REQUIRE(to<std::string>(um) == "{a: 1}");
+
+    std::vector<std::set<int> > vs =
+        parse<std::vector<std::set<int> > >("[[2, 1], [3]]");
+    REQUIRE(to<std::string>(vs) == "[[1, 2], [3]]");
+    REQUIRE(conv::formatted_size(vs) == 13);
+}
+
+#if __cplusplus >= 201703L
+TEST_CASE("memory resources", "[allocator]") {
+    typedef std::pmr::vector<std::pmr::vector<std::pmr::string> > vector_t;
+    typedef std::pmr::map<std::pmr::string, std::pmr::vector<int> > map_t;
+
+    std::pmr::monotonic_buffer_resource arena;
+
+    vector_t v = parse<vector_t>("[[a string too long for small buffers], [b]]",
+                                 &arena);
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[0][0] == "a string too long for small buffers");
+    REQUIRE(v[0].get_allocator().resource() == &arena);
+    REQUIRE(v[0][0].get_allocator().resource() == &arena);
+
+    map_t m = parse<map_t>("{a: [1, 2]}", &arena);
+    REQUIRE(m.begin()->first.get_allocator().resource() == &arena);
+    REQUIRE(m.begin()->second.get_allocator().resource() == &arena);
+
+    std::pmr::string s = to<std::pmr::string>(m, &arena);
+    REQUIRE(s == "{a: [1, 2]}");
+    REQUIRE(s.get_allocator().resource() == &arena);
+
+    std::vector<int> ints(2, 10);
+    std::pmr::list<std::pmr::string> l =
+        to<std::pmr::list<std::pmr::string> >(ints, &arena);
+    REQUIRE(l.front() == "10");
+    REQUIRE(l.front().get_allocator().resource() == &arena);
+}
+#endif
+
+TEST_CASE("conversion stats", "[stats]") {
+    conv::reset_stats();
+
+    REQUIRE(to<std::string>(12) == "12");
+    REQUIRE(to<int>("34") == 34);
+
+    conv::conversion_stats s = conv::stats();
+
+#if defined(CONV_ENABLE_STATS)
+    REQUIRE(s[conv::stat_format].calls == 1);
+    REQUIRE(s[conv::stat_format].stream_fallbacks == 0);
+    REQUIRE(s[conv::stat_read].calls == 1);
+    REQUIRE(s.total().calls == 2);
+
+    conv::reset_stats();
+    std::string digits = to<std::string>(-1234567890123456789LL);
+    REQUIRE(digits.size() == 20);
+    REQUIRE(to<int>("-34") == -34);
+
+    s = conv::stats();
+    REQUIRE(s[conv::stat_format].allocations >= 1);
+    REQUIRE(s[conv::stat_format].allocated_bytes >= 21);
+    REQUIRE(s[conv::stat_read].allocations == 0);
+
+    conv::reset_stats();
+    REQUIRE(conv::stats().total().calls == 0);
+#else
+    REQUIRE(s.total().calls == 0);
+#endif
+}
+
+TEST_CASE("latency histograms", "[latency]") {
+    conv::reset_latencies();
+
+    int sum = 0;
+
+    for (int i = 0; i < 100; ++i) {
+        sum += to<int>("42");
+    }
+
+    REQUIRE(sum == 4200);
+
+    std::vector<conv::latency_summary> l = conv::latencies();
+
+#if defined(CONV_ENABLE_LATENCY)
+    REQUIRE(l.size() == 1);
+    REQUIRE(l[0].name == "to<int>(std::string)");
+    REQUIRE(l[0].count == 100);
+    REQUIRE(l[0].p50 <= l[0].p99);
+    REQUIRE(l[0].p99 <= l[0].p999);
+    REQUIRE(l[0].p999 <= l[0].max);
+#else
+    REQUIRE(l.empty());
+#endif
+}
+
+struct thousands : std::numpunct<char> {
+    char do_thousands_sep() const { return ','; }
+    std::string do_grouping() const { return "\3"; }
+};
+
+struct count {
+    int n;
+};
+
+static std::istream& operator>>(std::istream& in, count& c) {
+    return in >> c.n;
+}
+
+// Restores the global locale even when a REQUIRE fails.
+struct global_locale {
+    explicit global_locale(const std::locale& loc)
+          : previous(std::locale::global(loc)) {}
+    ~global_locale() { std::locale::global(previous); }
+
+    std::locale previous;
+};
+
+// Restores LC_NUMERIC of the C library; set() fails when the locale is not
+// installed.
+struct c_numeric_locale {
+    c_numeric_locale() : previous(std::setlocale(LC_NUMERIC, NULL)) {}
+    ~c_numeric_locale() { std::setlocale(LC_NUMERIC, previous.c_str()); }
+
+    bool set(const char* name) {
+        return std::setlocale(LC_NUMERIC, name) != NULL;
+    }
+
+    std::string previous;
+};
+
+TEST_CASE("global locale", "[locale]") {
+    std::locale grouped(std::locale::classic(), new thousands);
+    global_locale guard(grouped);
+
+    point p = {1234, 5};
+    REQUIRE(to<std::string>(p) == "<1234 5 617>");
+    REQUIRE(to<std::string>(1234567) == "1234567");
+    REQUIRE(static_cast<count>(to<count>("1234")).n == 1234);
+
+    REQUIRE(to<std::string>(1234567, grouped) == "1,234,567");
+    REQUIRE(to<int>(std::string("1,234,567"), grouped) == 1234567);
+}
+
+TEST_CASE("C library numeric locale", "[locale]") {
+    c_numeric_locale guard;
+
+    if (!guard.set("de_DE.UTF-8") && !guard.set("de_DE")) {
+        return;  // no locale with a decimal comma is installed
+    }
+
+    REQUIRE(to<std::string>(1.5) == "1.5");
+    REQUIRE(to<double>("1.5") == 1.5);
+    REQUIRE(to<double>(L"-0.25") == -0.25);
+    REQUIRE(to<std::string>(std::vector<double>(1, 2.5)) == "[2.5]");
+}
+
+struct meddler {
+    int n;
+};
+
+static const int meddler_index = std::ios_base::xalloc();
+
+static std::ostream& operator<<(std::ostream& out, const meddler& m) {
+    out << out.iword(meddler_index)++ << " ";
+    out.imbue(std::locale(std::locale::classic(), new thousands));
+    out.exceptions(std::ios_base::badbit);
+    out << std::hex << m.n;
+    return out;
+}
+
+TEST_CASE("stream state is reset between uses", "[user]") {
+    meddler m = {255};
+    REQUIRE(to<std::string>(m) == "0 ff");
+    REQUIRE(to<std::string>(m) == "0 ff");
+
+    point p = {1234, 5};
+    REQUIRE(to<std::string>(p) == "<1234 5 617>");
+}
+
+#if defined(CONV_HAS_INT128)
+TEST_CASE("128-bit integers", "[int128]") {
+    conv::uint128_t umax = ~conv::uint128_t(0);
+    conv::int128_t imin = static_cast<conv::int128_t>(umax >> 1) * -1 - 1;
+
+    REQUIRE(to<std::string>(umax) == "340282366920938463463374607431768211455");
+    REQUIRE(to<std::string>(imin) ==
+            "-170141183460469231731687303715884105728");
+    REQUIRE(conv::formatted_size(imin) == 40);
+
+    conv::uint128_t u = to<conv::uint128_t>(
+        "340282366920938463463374607431768211455");
+    REQUIRE((u == umax));
+
+    conv::int128_t i = to<conv::int128_t>(
+        "-170141183460469231731687303715884105728");
+    REQUIRE((i == imin));
+
+    i = to<conv::int128_t>("0x10000000000000000");
+    REQUIRE((i == static_cast<conv::int128_t>(1) << 64));
+
+    std::vector<conv::int128_t> v =
+        parse<std::vector<conv::int128_t> >("[1, -100000000000000000000]");
+    REQUIRE(to<std::string>(v) == "[1, -100000000000000000000]");
+}
+#endif
+
+TEST_CASE("fixed point", "[fixed]") {
+    REQUIRE(to<std::string>(conv::fixed(12345, 2)) == "123.45");
+    REQUIRE(to<std::string>(conv::fixed(-5, 3)) == "-0.005");
+    REQUIRE(to<std::string>(conv::fixed(100LL, 2)) == "1.00");
+    REQUIRE(to<std::string>(conv::fixed(7u, 0)) == "7");
+    REQUIRE(conv::formatted_size(conv::fixed(-5, 3)) == 6);
+}